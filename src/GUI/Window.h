@@ -25,7 +25,25 @@
 #include <ostream>
 #include <sigc++/functors/mem_fun.h>
 #include <gtkmm/messagedialog.h>
+#include <glibmm/dispatcher.h>
+#include <boost/asio/post.hpp>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include "../Concurrency/ThreadPool.h"
+
+// What A Pool Task Hands Back To The Window, Shared So A Task That Outlives
+// The Window ( Closed Mid Navigation ) Never Touches It
+struct PageHandoff {
+    std::mutex mut;
+    std::unique_ptr<PreparedDocument> page;
+    std::string error;
+    size_t generation = 0;
+    // the window's dispatcher, null once the window is destroyed
+    Glib::Dispatcher* disp = nullptr;
+
+    void detach() { std::lock_guard<std::mutex> lock(mut); disp = nullptr; };
+};
 
 class BrowserWindow : public Gtk::Window {
     HttpManager* http_manager;
@@ -38,6 +56,75 @@ class BrowserWindow : public Gtk::Window {
     Gtk::ScrolledWindow* content_box_member;
     Gtk::Box* actual_box_member;
 
+    // pages are fetched, lexed, parsed and indexed on Concurrency::pool,
+    // only the widget construction is handed back to the main loop
+    Glib::Dispatcher page_ready_dispatcher;
+    std::shared_ptr<PageHandoff> page_handoff = std::make_shared<PageHandoff>();
+    size_t navigation_generation = 0;
+
+    void loadPageInBackground(std::string url, bool has_net){
+        size_t generation = ++navigation_generation;
+        // the task only holds the handoff and the manager ( which outlives every window ), never this
+        boost::asio::post(Concurrency::pool, [handoff = page_handoff, http_manager = http_manager,
+            url, has_net, generation](){
+            std::unique_ptr<PreparedDocument> prepared;
+            std::string error;
+            try{
+                std::string html_text;
+                if(has_net){
+                    html_text = http_manager->getRequest(url);
+                } else {
+                    std::ifstream fstrea(url, std::ios::ate);
+
+                    size_t size = fstrea.tellg();
+
+                    html_text.resize(size);
+                    fstrea.seekg(0, std::ios::beg);
+                    fstrea.read(&html_text[0], size);
+
+                    fstrea.close();
+                }
+                prepared = std::make_unique<PreparedDocument>(
+                    Interpreter::prepareDocument(std::move(html_text), url));
+            } catch(boost::wrapexcept<boost::system::system_error>& exception) {
+                error = exception.what();
+            } catch(std::exception& exception) {
+                error = exception.what();
+            }
+
+            std::lock_guard<std::mutex> lock(handoff->mut);
+            // the window is gone, or a slower, older navigation must not overwrite a newer result
+            if(!handoff->disp || generation < handoff->generation)
+                return;
+            handoff->page = std::move(prepared);
+            handoff->error = std::move(error);
+            handoff->generation = generation;
+            handoff->disp->emit();
+        });
+    }
+
+    void onPageReady(){
+        std::unique_ptr<PreparedDocument> prepared;
+        std::string error;
+        {
+            std::lock_guard<std::mutex> lock(page_handoff->mut);
+            // the user navigated again while this page was being prepared
+            if(page_handoff->generation != navigation_generation)
+                return;
+            prepared = std::move(page_handoff->page);
+            error = std::move(page_handoff->error);
+        }
+        if(!error.empty()){
+            std::cout << error << std::endl;
+            return;
+        }
+        if(!prepared)
+            return;
+
+        interpreter.target_window = this;
+        interpreter.renderPreparedDocument(actual_box_member, *prepared);
+    }
+
 public:
 
     bool on_close_request() override {
@@ -91,38 +178,17 @@ public:
             if(keyval == GDK_KEY_Return && url_input->get_text_length() > 0){
 
                 if(has_net){
-                    try{
-                        std::string html_content = http_manager->getRequest(url_input->get_text());
-                        auto tokens = lexer.tokenize(html_content);
-                        auto program = parser.produceAst(tokens);
-                        interpreter.target_window = this;
-                        interpreter.renderTags(actual_box_member, program, url_input->get_text());
-                    } catch(boost::wrapexcept<boost::system::system_error>& exception) {
-                        std::cout << exception.what() << std::endl;
-                    }
+                    loadPageInBackground(url_input->get_text(), true);
                 } else {
                     std::string url = url_input->get_text();
-                    std::string html_text;
-                    if(fs::exists(url)){
-                        std::ifstream fstrea(url, std::ios::ate);
-
-                        size_t size = fstrea.tellg();
-
-                        html_text.resize(size);
-                        fstrea.seekg(0, std::ios::beg);
-                        fstrea.read(&html_text[0], size);
-        
-                        fstrea.close();
-                    } else {
+                    if(!fs::exists(url)){
                         std::cout << "requires internet to fetch . . .";
                         Gtk::MessageDialog msg(*this, "No Internet !");
                         msg.add_button("Ok", 0);
                         msg.show();
                         return;
                     };
-                    auto tokens = lexer.tokenize(html_text);
-                    auto program = parser.produceAst(tokens);
-                    interpreter.renderTags(actual_box_member, program, url);
+                    loadPageInBackground(url, false);
                 }
             }
         });
@@ -160,9 +226,12 @@ public:
              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
     }
     BrowserWindow(HttpManager* httpManager): http_manager(httpManager){
+        page_ready_dispatcher.connect(sigc::mem_fun(*this, &BrowserWindow::onPageReady));
+        page_handoff->disp = &page_ready_dispatcher;
         if(httpManager)
             init();
         else init(false);
     };
+    ~BrowserWindow() { page_handoff->detach(); };
 
 };
@@ -0,0 +1,171 @@
+#include "ConnectionPool.h"
+#include <cerrno>
+#include <openssl/ssl.h>
+#include <sys/socket.h>
+
+ConnectionPool::ConnectionPool(ConnectionPoolLimits pool_limits): limits(pool_limits) {
+};
+
+ConnectionPool::~ConnectionPool() {
+    closeIdle();
+};
+
+std::unique_ptr<PooledConnection> ConnectionPool::acquire(const std::string& host_key) {
+    std::unique_lock<std::mutex> lock(pool_mut);
+
+    slot_freed.wait(lock, [&]{ return hasSlot(host_key); });
+    return take(host_key);
+};
+
+std::unique_ptr<PooledConnection> ConnectionPool::tryAcquire(const std::string& host_key,
+    std::function<void()> on_slot_freed){
+    std::lock_guard<std::mutex> lock(pool_mut);
+    if(hasSlot(host_key))
+        return take(host_key);
+    slot_waiters[host_key].push_back(std::move(on_slot_freed));
+    return nullptr;
+};
+
+bool ConnectionPool::hasSlot(const std::string& host_key) {
+    auto& idle = idle_connections[host_key];
+    return checked_out[host_key] + idle.size() < limits.max_per_host || !idle.empty();
+};
+
+std::unique_ptr<PooledConnection> ConnectionPool::take(const std::string& host_key) {
+    checked_out[host_key]++;
+
+    auto& idle = idle_connections[host_key];
+
+    auto now = std::chrono::steady_clock::now();
+    while(!idle.empty()){
+        std::unique_ptr<PooledConnection> connection = std::move(idle.back());
+        idle.pop_back();
+        idle_total--;
+
+        if(now - connection->last_used < limits.idle_timeout && !isStale(*connection)){
+            reused_count++;
+            return connection;
+        }
+        close(*connection);
+    }
+
+    opened_count++;
+    auto connection = std::make_unique<PooledConnection>();
+    connection->host_key = host_key;
+    return connection;
+};
+
+void ConnectionPool::release(std::unique_ptr<PooledConnection> connection, bool reusable) {
+    std::vector<std::function<void()>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(pool_mut);
+        checked_out[connection->host_key]--;
+        waiters.swap(slot_waiters[connection->host_key]);
+
+        if(reusable && connection->stream){
+            connection->last_used = std::chrono::steady_clock::now();
+            connection->requests_served++;
+
+            auto& idle = idle_connections[connection->host_key];
+            if(idle.size() >= limits.max_idle_per_host){
+                close(*idle.front());
+                idle.pop_front();
+                idle_total--;
+            }
+            if(idle_total >= limits.max_idle_total)
+                evictOldestIdle();
+
+            idle.push_back(std::move(connection));
+            idle_total++;
+        }
+    }
+    if(connection && connection->stream)
+        close(*connection);
+    slot_freed.notify_all();
+    // all of them, like notify_all, the ones that lose the race wait again
+    for(auto& on_slot_freed : waiters)
+        on_slot_freed();
+};
+
+void ConnectionPool::evictOldestIdle() {
+    std::deque<std::unique_ptr<PooledConnection>>* oldest = nullptr;
+    for(auto& [host_key, idle] : idle_connections)
+        if(!idle.empty() && (oldest == nullptr || idle.front()->last_used < oldest->front()->last_used))
+            oldest = &idle;
+
+    if(oldest == nullptr)
+        return;
+    close(*oldest->front());
+    oldest->pop_front();
+    idle_total--;
+};
+
+void ConnectionPool::closeIdle() {
+    std::lock_guard<std::mutex> lock(pool_mut);
+    for(auto& [host_key, idle] : idle_connections)
+        for(auto& connection : idle)
+            close(*connection);
+    idle_connections.clear();
+    idle_total = 0;
+};
+
+bool ConnectionPool::isStale(PooledConnection& connection) {
+    if(!connection.stream || !connection.stream->getSocket().is_open())
+        return true;
+    // decrypted bytes nobody asked for, the stream is out of sync
+    if(connection.stream->isTls() && SSL_pending(connection.stream->getSsl()) > 0)
+        return true;
+
+    // 0 = the server closed it, > 0 = a close_notify / stray response is waiting,
+    // only "would block" means the connection is quietly alive
+    char byte;
+    ssize_t peeked = ::recv(connection.stream->getSocket().native_handle(), &byte, 1,
+        MSG_PEEK | MSG_DONTWAIT);
+    if(peeked >= 0)
+        return true;
+    return errno != EAGAIN && errno != EWOULDBLOCK;
+};
+
+void ConnectionPool::close(PooledConnection& connection) {
+    if(!connection.stream)
+        return;
+    // no tls shutdown, it's a blocking round trip the server doesn't need, but openssl has to
+    // think one happened, otherwise SSL_free marks the session unresumable
+    if(connection.stream->isTls())
+        SSL_set_shutdown(connection.stream->getSsl(), SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    boost::system::error_code ec;
+    connection.stream->getSocket().close(ec);
+    connection.stream.reset();
+};
+
+size_t ConnectionPool::getOpenedCount() {
+    std::lock_guard<std::mutex> lock(pool_mut);
+    return opened_count;
+};
+
+size_t ConnectionPool::getReusedCount() {
+    std::lock_guard<std::mutex> lock(pool_mut);
+    return reused_count;
+};
+
+size_t ConnectionPool::getIdleCount() {
+    std::lock_guard<std::mutex> lock(pool_mut);
+    return idle_total;
+};
+
+ConnectionLease::ConnectionLease(ConnectionPool& connection_pool, const std::string& host_key):
+    pool(connection_pool), connection(connection_pool.acquire(host_key)) {
+};
+
+ConnectionLease::ConnectionLease(ConnectionPool& connection_pool, std::unique_ptr<PooledConnection> acquired):
+    pool(connection_pool), connection(std::move(acquired)) {
+};
+
+ConnectionLease::~ConnectionLease() {
+    if(connection)
+        release(false);
+};
+
+void ConnectionLease::release(bool reusable) {
+    pool.release(std::move(connection), reusable);
+};
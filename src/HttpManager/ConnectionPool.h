@@ -0,0 +1,99 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include "HttpTransport.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+//
+//  Keeps Finished Keep-Alive Connections Around Per Host, So Every Request After The First
+//  Skips Dns, The Tcp Handshake And The Tls Handshake ( One Round Trip Instead Of Three+ )
+//
+
+struct PooledConnection {
+    std::string host_key;
+    // null when the pool had nothing idle, the caller connects and fills it in
+    std::unique_ptr<HttpTransport> stream;
+    std::chrono::steady_clock::time_point last_used;
+    size_t requests_served = 0;
+};
+
+struct ConnectionPoolLimits {
+    size_t max_per_host = 6; // idle + checked out, like browsers do for http/1.1
+    size_t max_idle_per_host = 6;
+    size_t max_idle_total = 32;
+    std::chrono::seconds idle_timeout = std::chrono::seconds(30);
+};
+
+class ConnectionPool {
+public:
+    explicit ConnectionPool(ConnectionPoolLimits pool_limits = {});
+    ~ConnectionPool();
+
+    // thread safe, blocks while max_per_host connections to the host are checked out,
+    // every acquire must be paired with a release, ConnectionLease does both
+    std::unique_ptr<PooledConnection> acquire(const std::string& host_key);
+    // same without blocking, for an io thread. null while the host is at max_per_host, on_slot_freed
+    // is then called once by the next release for the host ( on the releasing thread ) to try again
+    std::unique_ptr<PooledConnection> tryAcquire(const std::string& host_key, std::function<void()> on_slot_freed);
+    // reusable = the response allowed keep-alive and was read completely
+    void release(std::unique_ptr<PooledConnection> connection, bool reusable);
+
+    void closeIdle();
+
+    size_t getOpenedCount();
+    size_t getReusedCount();
+    size_t getIdleCount();
+
+    static bool isStale(PooledConnection& connection);
+    static void close(PooledConnection& connection);
+
+private:
+    ConnectionPoolLimits limits;
+
+    std::mutex pool_mut;
+    std::condition_variable slot_freed;
+    // most recently used at the back
+    std::unordered_map<std::string, std::deque<std::unique_ptr<PooledConnection>>> idle_connections;
+    std::unordered_map<std::string, size_t> checked_out;
+    std::unordered_map<std::string, std::vector<std::function<void()>>> slot_waiters;
+    size_t idle_total = 0;
+    size_t opened_count = 0;
+    size_t reused_count = 0;
+
+    bool hasSlot(const std::string& host_key);
+    // the caller holds pool_mut and has checked hasSlot
+    std::unique_ptr<PooledConnection> take(const std::string& host_key);
+    void evictOldestIdle();
+};
+
+// one checked out connection, given back to the pool when the lease goes away. unless release
+// said it's reusable it's closed then, so an exception of any kind can't keep the host's slot
+class ConnectionLease {
+public:
+    ConnectionLease(ConnectionPool& connection_pool, const std::string& host_key);
+    // for a connection that was already acquired
+    ConnectionLease(ConnectionPool& connection_pool, std::unique_ptr<PooledConnection> acquired);
+    ~ConnectionLease();
+    ConnectionLease(const ConnectionLease&) = delete;
+    ConnectionLease& operator=(const ConnectionLease&) = delete;
+
+    PooledConnection* operator->() { return connection.get(); };
+    // gives the connection back now, the lease is empty afterwards
+    void release(bool reusable);
+
+private:
+    ConnectionPool& pool;
+    std::unique_ptr<PooledConnection> connection;
+};
@@ -0,0 +1,129 @@
+#include "ContentDecoder.h"
+#include <algorithm>
+#include <cctype>
+
+ContentDecoder::ContentDecoder(ContentEncoding content_encoding): encoding(content_encoding) {
+    if(encoding == GzipEncoding)
+        initZlib(16 + MAX_WBITS);
+    else if(encoding == DeflateEncoding)
+        initZlib(MAX_WBITS);
+    else if(encoding == BrotliEncoding)
+        brotli_state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+};
+
+ContentDecoder::~ContentDecoder() {
+    if(zlib_ready)
+        inflateEnd(&zlib_stream);
+    if(brotli_state)
+        BrotliDecoderDestroyInstance(brotli_state);
+};
+
+void ContentDecoder::initZlib(int window_bits) {
+    if(zlib_ready)
+        inflateEnd(&zlib_stream);
+    zlib_stream = {};
+    zlib_ready = inflateInit2(&zlib_stream, window_bits) == Z_OK;
+};
+
+ContentEncoding ContentDecoder::getEncoding(std::string_view content_encoding) {
+    std::string lowered(content_encoding);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(),
+        [](unsigned char c){ return std::tolower(c); });
+    lowered.erase(std::remove_if(lowered.begin(), lowered.end(),
+        [](unsigned char c){ return std::isspace(c); }), lowered.end());
+
+    if(lowered.empty() || lowered == "identity") return IdentityEncoding;
+    if(lowered == "gzip" || lowered == "x-gzip") return GzipEncoding;
+    if(lowered == "deflate") return DeflateEncoding;
+    if(lowered == "br") return BrotliEncoding;
+    // stacked encodings or ones we never asked for
+    return UnsupportedEncoding;
+};
+
+bool ContentDecoder::decode(std::string_view input, std::string& output) {
+    if(!input.empty())
+        saw_input = true;
+    switch(encoding){
+        case IdentityEncoding:
+            output.append(input);
+            return true;
+        case GzipEncoding: case DeflateEncoding:
+            return decodeZlib(input, output);
+        case BrotliEncoding:
+            return decodeBrotli(input, output);
+        default:
+            return false;
+    }
+};
+
+bool ContentDecoder::finish() {
+    // an empty body ( a 204, or a HEAD with the encoding header still on it ) was never compressed
+    return encoding == IdentityEncoding || stream_ended || !saw_input;
+};
+
+bool ContentDecoder::decodeZlib(std::string_view input, std::string& output) {
+    if(!zlib_ready)
+        return false;
+    // anything after the end of the stream ( trailing garbage some servers add ) is dropped
+    if(stream_ended)
+        return true;
+
+    zlib_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zlib_stream.avail_in = input.size();
+
+    char chunk[16 * 1024];
+    do {
+        zlib_stream.next_out = reinterpret_cast<Bytef*>(chunk);
+        zlib_stream.avail_out = sizeof(chunk);
+
+        int result = inflate(&zlib_stream, Z_NO_FLUSH);
+        if(result == Z_DATA_ERROR && encoding == DeflateEncoding && !produced_output && !tried_raw_deflate){
+            // no zlib header, the same bytes again as a raw deflate stream
+            tried_raw_deflate = true;
+            initZlib(-MAX_WBITS);
+            return decodeZlib(input, output);
+        }
+        if(result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+            return false;
+
+        size_t produced = sizeof(chunk) - zlib_stream.avail_out;
+        if(produced > 0){
+            output.append(chunk, produced);
+            produced_output = true;
+        }
+        if(result == Z_STREAM_END){
+            stream_ended = true;
+            return true;
+        }
+        if(result == Z_BUF_ERROR)
+            break;
+    } while(zlib_stream.avail_in > 0 || zlib_stream.avail_out == 0);
+
+    return true;
+};
+
+bool ContentDecoder::decodeBrotli(std::string_view input, std::string& output) {
+    if(!brotli_state)
+        return false;
+    if(stream_ended)
+        return true;
+
+    const uint8_t* next_in = reinterpret_cast<const uint8_t*>(input.data());
+    size_t avail_in = input.size();
+    uint8_t chunk[16 * 1024];
+
+    for(;;){
+        uint8_t* next_out = chunk;
+        size_t avail_out = sizeof(chunk);
+        BrotliDecoderResult result = BrotliDecoderDecompressStream(brotli_state,
+            &avail_in, &next_in, &avail_out, &next_out, nullptr);
+        output.append(reinterpret_cast<const char*>(chunk), sizeof(chunk) - avail_out);
+
+        switch(result){
+            case BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT: continue;
+            case BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT: return true;
+            case BROTLI_DECODER_RESULT_SUCCESS: stream_ended = true; return true;
+            default: return false;
+        }
+    }
+};
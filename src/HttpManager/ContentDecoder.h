@@ -0,0 +1,109 @@
+#pragma once
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/optional.hpp>
+#include <boost/system/error_code.hpp>
+#include <brotli/decode.h>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <zlib.h>
+
+//
+//  Undoes A Response's Content-Encoding One Chunk At A Time, As The Bytes Come Off The Socket,
+//  So The Compressed Body Is Never Held In Full, Only The Decoded Text It Turns Into
+//
+
+enum ContentEncoding {
+    IdentityEncoding, GzipEncoding, DeflateEncoding, BrotliEncoding, UnsupportedEncoding
+};
+
+class ContentDecoder {
+public:
+    // what every request advertises, in the order we'd like them
+    static constexpr std::string_view accept_encoding = "br, gzip, deflate";
+
+    explicit ContentDecoder(ContentEncoding content_encoding);
+    ~ContentDecoder();
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+    static ContentEncoding getEncoding(std::string_view content_encoding);
+
+    // appends whatever the input decodes to, false on a corrupt stream
+    bool decode(std::string_view input, std::string& output);
+    // false if the stream stopped in the middle, true if no input came at all
+    bool finish();
+
+private:
+    ContentEncoding encoding;
+    z_stream zlib_stream = {};
+    BrotliDecoderState* brotli_state = nullptr;
+    bool zlib_ready = false;
+    bool stream_ended = false;
+    bool saw_input = false;
+    // "deflate" is meant to be zlib wrapped, some servers send it raw anyway
+    bool produced_output = false;
+    bool tried_raw_deflate = false;
+
+    bool decodeZlib(std::string_view input, std::string& output);
+    bool decodeBrotli(std::string_view input, std::string& output);
+    void initZlib(int window_bits);
+};
+
+// a string body whose reader runs every chunk through a ContentDecoder on its way in,
+// so the message ends up with the decoded text whatever the server compressed it with
+struct DecodedStringBody {
+    typedef std::string value_type;
+
+    static std::uint64_t size(const value_type& body) { return body.size(); };
+
+    class reader {
+    public:
+        // the parser builds its reader before the header is parsed, the encoding is looked up in init
+        template<bool isRequest, class Fields>
+        explicit reader(boost::beast::http::header<isRequest, Fields>& header, value_type& target_body):
+            body(target_body), get_content_encoding([&header](){
+                auto value = header[boost::beast::http::field::content_encoding];
+                return std::string_view(value.data(), value.size());
+            }) {};
+
+        void init(const boost::optional<std::uint64_t>&, boost::system::error_code& ec) {
+            decoder.emplace(ContentDecoder::getEncoding(get_content_encoding()));
+            ec = {};
+        };
+
+        template<class ConstBufferSequence>
+        std::size_t put(const ConstBufferSequence& buffers, boost::system::error_code& ec) {
+            std::size_t consumed = 0;
+            for(auto buffer : boost::beast::buffers_range_ref(buffers)){
+                if(!decoder->decode(std::string_view(static_cast<const char*>(buffer.data()), buffer.size()), body)){
+                    ec = boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence);
+                    return consumed;
+                }
+                consumed += buffer.size();
+            }
+            ec = {};
+            return consumed;
+        };
+
+        // init is skipped for bodies known to be empty ( 304, 204, Content-Length: 0 ), so there may be no decoder
+        void finish(boost::system::error_code& ec) {
+            if(decoder && !decoder->finish())
+                ec = boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence);
+            else
+                ec = {};
+        };
+
+    private:
+        value_type& body;
+        std::function<std::string_view()> get_content_encoding;
+        std::optional<ContentDecoder> decoder;
+    };
+
+    // requests never carry an encoded body, so the writer is the plain string one
+    typedef boost::beast::http::string_body::writer writer;
+};
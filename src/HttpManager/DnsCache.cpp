@@ -0,0 +1,132 @@
+#include "DnsCache.h"
+#include <algorithm>
+
+DnsCache::DnsCache(std::chrono::seconds default_ttl, std::chrono::seconds negative_ttl, size_t max_hosts):
+    positive_ttl(default_ttl), failure_ttl(negative_ttl), max_cached_hosts(max_hosts) {
+};
+
+std::string DnsCache::getKey(const std::string& host_name, const std::string& service) {
+    return host_name + ":" + service;
+};
+
+DnsAnswer DnsCache::resolveWithSystem(const std::string& host_name, const std::string& service,
+    std::chrono::seconds ttl) {
+    // a resolver per call, a shared one isn't safe to use from several pool threads at once
+    net::io_context resolve_ctx;
+    tcp::resolver system_resolver(resolve_ctx);
+
+    DnsAnswer answer = {{}, ttl};
+    for(auto& entry : system_resolver.resolve(host_name, service))
+        answer.endpoints.push_back(entry.endpoint());
+    return answer;
+};
+
+void DnsCache::setResolver(DnsResolveFunction resolve_function) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    resolver = std::move(resolve_function);
+    answers.clear();
+};
+
+bool DnsCache::hasCustomResolver() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return resolver != nullptr;
+};
+
+std::optional<std::vector<tcp::endpoint>> DnsCache::lookup(const std::string& host_name,
+    const std::string& service) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    auto itr = answers.find(getKey(host_name, service));
+    if(itr == answers.end() || itr->second.expires_at <= std::chrono::steady_clock::now()){
+        misses++;
+        return std::nullopt;
+    }
+
+    if(itr->second.error){
+        negative_hits++;
+        throw boost::system::system_error(itr->second.error, host_name);
+    }
+    hits++;
+    return itr->second.endpoints;
+};
+
+std::vector<tcp::endpoint> DnsCache::resolve(const std::string& host_name, const std::string& service) {
+    if(std::optional<std::vector<tcp::endpoint>> cached = lookup(host_name, service))
+        return std::move(*cached);
+
+    DnsResolveFunction resolve_function;
+    {
+        std::lock_guard<std::mutex> lock(cache_mut);
+        resolve_function = resolver;
+    }
+
+    DnsAnswer answer;
+    try {
+        answer = resolve_function ? resolve_function(host_name, service) :
+            resolveWithSystem(host_name, service, positive_ttl);
+    } catch(const boost::system::system_error& error) {
+        storeFailure(host_name, service, error.code());
+        throw;
+    }
+
+    std::vector<tcp::endpoint> endpoints = answer.endpoints;
+    store(host_name, service, std::move(answer));
+    return endpoints;
+};
+
+std::vector<tcp::endpoint> DnsCache::store(const std::string& host_name, const std::string& service,
+    const tcp::resolver::results_type& results) {
+    DnsAnswer answer = {{}, positive_ttl};
+    for(auto& entry : results)
+        answer.endpoints.push_back(entry.endpoint());
+
+    std::vector<tcp::endpoint> endpoints = answer.endpoints;
+    store(host_name, service, std::move(answer));
+    return endpoints;
+};
+
+void DnsCache::store(const std::string& host_name, const std::string& service, DnsAnswer answer) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    insert(getKey(host_name, service), {std::move(answer.endpoints), {},
+        std::chrono::steady_clock::now() + answer.ttl});
+};
+
+void DnsCache::storeFailure(const std::string& host_name, const std::string& service,
+    boost::system::error_code error) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    insert(getKey(host_name, service), {{}, error, std::chrono::steady_clock::now() + failure_ttl});
+};
+
+void DnsCache::insert(std::string key, CachedAnswer answer) {
+    if(answers.size() >= max_cached_hosts && !answers.contains(key)){
+        // expired ones first, if none are then whichever expires soonest
+        auto now = std::chrono::steady_clock::now();
+        std::erase_if(answers, [now](auto& entry){ return entry.second.expires_at <= now; });
+        if(answers.size() >= max_cached_hosts){
+            auto soonest = std::min_element(answers.begin(), answers.end(), [](auto& lhs, auto& rhs){
+                return lhs.second.expires_at < rhs.second.expires_at;
+            });
+            answers.erase(soonest);
+        }
+    }
+    answers.insert_or_assign(std::move(key), std::move(answer));
+};
+
+void DnsCache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    answers.clear();
+};
+
+size_t DnsCache::getHits() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return hits;
+};
+
+size_t DnsCache::getNegativeHits() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return negative_hits;
+};
+
+size_t DnsCache::getMisses() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return misses;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+//
+//  Remembers What Each Host Resolved To ( And Which Hosts Failed To Resolve ) For A While, So
+//  Navigating Around The Same Sites Goes Straight To Connecting Instead Of Asking Dns Every Time
+//
+
+struct DnsAnswer {
+    std::vector<tcp::endpoint> endpoints;
+    std::chrono::seconds ttl;
+};
+
+// throws boost::system::system_error when the name doesn't resolve
+typedef std::function<DnsAnswer(const std::string& host_name, const std::string& service)> DnsResolveFunction;
+
+class DnsCache {
+public:
+    // getaddrinfo doesn't tell us the record ttls, the system resolver's answers get these
+    explicit DnsCache(std::chrono::seconds default_ttl = std::chrono::seconds(60),
+        std::chrono::seconds negative_ttl = std::chrono::seconds(10), size_t max_hosts = 512);
+
+    // replaces the system resolver, a stub one makes the cache testable without a network
+    void setResolver(DnsResolveFunction resolve_function);
+    bool hasCustomResolver();
+
+    // the cached endpoints, nullopt if the host has to be resolved. throws a cached failure
+    std::optional<std::vector<tcp::endpoint>> lookup(const std::string& host_name, const std::string& service);
+    // lookup, and on a miss resolve on the calling thread and remember the result
+    std::vector<tcp::endpoint> resolve(const std::string& host_name, const std::string& service);
+
+    // for answers that were resolved elsewhere ( the async resolver on the http io thread )
+    std::vector<tcp::endpoint> store(const std::string& host_name, const std::string& service,
+        const tcp::resolver::results_type& results);
+    void store(const std::string& host_name, const std::string& service, DnsAnswer answer);
+    void storeFailure(const std::string& host_name, const std::string& service, boost::system::error_code error);
+
+    void clear();
+
+    size_t getHits();
+    size_t getNegativeHits();
+    size_t getMisses();
+
+private:
+    struct CachedAnswer {
+        std::vector<tcp::endpoint> endpoints;
+        boost::system::error_code error;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    std::mutex cache_mut;
+    std::unordered_map<std::string, CachedAnswer> answers;
+    DnsResolveFunction resolver;
+    std::chrono::seconds positive_ttl;
+    std::chrono::seconds failure_ttl;
+    size_t max_cached_hosts;
+    size_t hits = 0;
+    size_t negative_hits = 0;
+    size_t misses = 0;
+
+    static std::string getKey(const std::string& host_name, const std::string& service);
+    static DnsAnswer resolveWithSystem(const std::string& host_name, const std::string& service,
+        std::chrono::seconds ttl);
+    // expects cache_mut to be held
+    void insert(std::string key, CachedAnswer answer);
+};
@@ -0,0 +1,127 @@
+#include "HappyEyeballs.h"
+
+struct HappyEyeballs::Race : std::enable_shared_from_this<HappyEyeballs::Race> {
+    net::any_io_executor executor;
+    std::vector<tcp::endpoint> endpoints;
+    std::vector<std::unique_ptr<tcp::socket>> attempts;
+    net::steady_timer delay_timer;
+    std::chrono::milliseconds attempt_delay;
+    ConnectHandler handler;
+    size_t next_endpoint = 0;
+    size_t failed = 0;
+    bool finished = false;
+    boost::system::error_code last_error;
+
+    Race(net::any_io_executor race_executor, std::vector<tcp::endpoint> race_endpoints,
+        std::chrono::milliseconds delay, ConnectHandler on_connected): executor(race_executor),
+        endpoints(std::move(race_endpoints)), delay_timer(race_executor), attempt_delay(delay),
+        handler(std::move(on_connected)) {};
+
+    void startNext() {
+        if(finished || next_endpoint >= endpoints.size())
+            return;
+
+        tcp::socket* attempt = attempts.emplace_back(std::make_unique<tcp::socket>(executor)).get();
+        attempt->async_connect(endpoints[next_endpoint++], [self = shared_from_this(), attempt](boost::system::error_code ec){
+            self->onConnect(attempt, ec);
+        });
+
+        if(next_endpoint < endpoints.size()){
+            delay_timer.expires_after(attempt_delay);
+            delay_timer.async_wait([self = shared_from_this()](boost::system::error_code ec){
+                if(!ec)
+                    self->startNext();
+            });
+        }
+    };
+
+    void onConnect(tcp::socket* attempt, boost::system::error_code ec) {
+        if(finished)
+            return;
+
+        if(ec){
+            last_error = ec;
+            if(++failed == endpoints.size()){
+                finish(last_error, nullptr);
+                return;
+            }
+            // a refused attempt doesn't wait out the delay, the next one starts right away
+            if(failed == next_endpoint){
+                delay_timer.cancel();
+                startNext();
+            }
+            return;
+        }
+        finish({}, attempt);
+    };
+
+    void finish(boost::system::error_code ec, tcp::socket* winner) {
+        finished = true;
+        delay_timer.cancel();
+
+        tcp::socket result(executor);
+        for(auto& attempt : attempts){
+            if(attempt.get() == winner)
+                result = std::move(*attempt);
+            else {
+                boost::system::error_code ignored;
+                attempt->close(ignored);
+            }
+        }
+        handler(ec, std::move(result));
+    };
+};
+
+std::vector<tcp::endpoint> HappyEyeballs::interleave(const std::vector<tcp::endpoint>& endpoints) {
+    std::vector<tcp::endpoint> v6, v4, result;
+    for(auto& endpoint : endpoints)
+        (endpoint.address().is_v6() ? v6 : v4).push_back(endpoint);
+
+    for(size_t i = 0; i < std::max(v6.size(), v4.size()); i++){
+        if(i < v6.size()) result.push_back(v6[i]);
+        if(i < v4.size()) result.push_back(v4[i]);
+    }
+    return result;
+};
+
+void HappyEyeballs::asyncConnect(net::any_io_executor executor, const std::vector<tcp::endpoint>& endpoints,
+    ConnectHandler handler, std::chrono::milliseconds attempt_delay) {
+    if(endpoints.empty()){
+        net::post(executor, [executor, handler = std::move(handler)](){
+            handler(net::error::host_not_found, tcp::socket(executor));
+        });
+        return;
+    }
+
+    auto race = std::make_shared<Race>(executor, interleave(endpoints), attempt_delay, std::move(handler));
+    net::post(executor, [race](){ race->startNext(); });
+};
+
+net::awaitable<tcp::socket> HappyEyeballs::connect(const std::vector<tcp::endpoint>& endpoints) {
+    auto executor = co_await net::this_coro::executor;
+    co_return co_await net::async_initiate<const net::use_awaitable_t<>&, void(boost::system::error_code, tcp::socket)>(
+        [executor, &endpoints](auto completion){
+            // ConnectHandler has to be copyable, the coroutine's completion handler isn't
+            auto shared_completion = std::make_shared<decltype(completion)>(std::move(completion));
+            asyncConnect(executor, endpoints, [shared_completion](boost::system::error_code ec, tcp::socket socket){
+                (*shared_completion)(ec, std::move(socket));
+            });
+        }, net::use_awaitable);
+};
+
+tcp::socket HappyEyeballs::connect(net::io_context& target_ctx, const std::vector<tcp::endpoint>& endpoints) {
+    net::io_context race_ctx;
+    boost::system::error_code result;
+    tcp::socket winner(race_ctx);
+
+    asyncConnect(race_ctx.get_executor(), endpoints, [&result, &winner](boost::system::error_code ec, tcp::socket socket){
+        result = ec;
+        winner = std::move(socket);
+    });
+    race_ctx.run();
+
+    if(result)
+        throw boost::system::system_error(result);
+    tcp::endpoint local_endpoint = winner.local_endpoint();
+    return tcp::socket(target_ctx, local_endpoint.protocol(), winner.release());
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+//
+//  Rfc 8305 Style Connecting: Addresses Alternate Between Ipv6 And Ipv4, And Each Attempt Only
+//  Gets A Short Head Start Before The Next One Is Raced Against It, So A Broken Ipv6 Route ( Or
+//  One Dead Address ) Costs 250ms Instead Of A Full Tcp Timeout
+//
+
+typedef std::function<void(boost::system::error_code, tcp::socket)> ConnectHandler;
+
+class HappyEyeballs {
+public:
+    static constexpr std::chrono::milliseconds connection_attempt_delay{250};
+
+    // ipv6 first, then alternating families, keeping the resolver's order within each
+    static std::vector<tcp::endpoint> interleave(const std::vector<tcp::endpoint>& endpoints);
+
+    // the handler runs once on the executor with the first socket that connected
+    static void asyncConnect(net::any_io_executor executor, const std::vector<tcp::endpoint>& endpoints,
+        ConnectHandler handler, std::chrono::milliseconds attempt_delay = connection_attempt_delay);
+    static net::awaitable<tcp::socket> connect(const std::vector<tcp::endpoint>& endpoints);
+    // blocks, the race runs on a private io_context and the winner is handed over to target_ctx
+    static tcp::socket connect(net::io_context& target_ctx, const std::vector<tcp::endpoint>& endpoints);
+
+private:
+    struct Race;
+};
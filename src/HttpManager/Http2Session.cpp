@@ -0,0 +1,335 @@
+#include "Http2Session.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+Http2Session::Http2Session(std::unique_ptr<HttpTransport> tls_transport, const StreamLimits& stream_limits,
+    const Http2Settings& settings): transport(std::move(tls_transport)), limits(stream_limits),
+    session_settings(settings) {
+    nghttp2_session_callbacks* callbacks;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, onHeader);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, onDataChunk);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, onStreamClose);
+
+    // window credit goes back once the consumer has the data, not as soon as it's read
+    nghttp2_option* option;
+    nghttp2_option_new(&option);
+    nghttp2_option_set_no_auto_window_update(option, 1);
+
+    nghttp2_session_client_new2(&session, callbacks, this, option);
+    nghttp2_option_del(option);
+    nghttp2_session_callbacks_del(callbacks);
+};
+
+Http2Session::~Http2Session() {
+    nghttp2_session_del(session);
+};
+
+void Http2Session::offerAlpn(SSL* ssl) {
+    static const unsigned char protocols[] = "\x02h2\x08http/1.1";
+    SSL_set_alpn_protos(ssl, protocols, sizeof(protocols) - 1);
+};
+
+bool Http2Session::isNegotiated(HttpTransport& transport) {
+    SSL* ssl = transport.getSsl();
+    if(!ssl)
+        return false;
+
+    const unsigned char* protocol = nullptr;
+    unsigned int protocol_length = 0;
+    SSL_get0_alpn_selected(ssl, &protocol, &protocol_length);
+    return protocol_length == 2 && std::memcmp(protocol, "h2", 2) == 0;
+};
+
+int Http2Session::getWeight(RequestPriority priority) {
+    switch(priority){
+        case PriorityRenderBlocking: return NGHTTP2_MAX_WEIGHT;
+        case PriorityHigh: return 64;
+        case PriorityNormal: return NGHTTP2_DEFAULT_WEIGHT;
+        default: return 4;
+    }
+};
+
+void Http2Session::start() {
+    nghttp2_settings_entry settings[] = {
+        {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, session_settings.max_concurrent_streams},
+        {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, session_settings.stream_window_bytes},
+        {NGHTTP2_SETTINGS_ENABLE_PUSH, 0}
+    };
+    nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, settings, std::size(settings));
+    nghttp2_session_set_local_window_size(session, NGHTTP2_FLAG_NONE, 0, session_settings.connection_window_bytes);
+
+    net::co_spawn(transport->get_executor(), [self = shared_from_this()](){
+        return self->readLoop();
+    }, net::detached);
+    scheduleFlush();
+};
+
+bool Http2Session::isUsable() {
+    return !closed && nghttp2_session_check_request_allowed(session);
+};
+
+net::awaitable<http::response_header<>> Http2Session::request(const http::request<http::string_body>& req,
+    RequestPriority priority, ChunkConsumer consumer) {
+    std::shared_ptr<Http2Session> self = shared_from_this();
+    if(!isUsable())
+        throw boost::system::system_error(net::error::connection_reset);
+
+    auto method = req.method_string();
+    auto host = req[http::field::host];
+    auto target = req.target();
+    std::vector<std::pair<std::string, std::string>> fields = {
+        {":method", std::string(method.data(), method.size())}, {":scheme", "https"},
+        {":authority", std::string(host.data(), host.size())}, {":path", std::string(target.data(), target.size())}
+    };
+    for(const auto& field : req){
+        auto field_name = field.name_string();
+        std::string name(field_name.data(), field_name.size());
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        // connection specific, http/2 forbids them ( and the host is the :authority already )
+        if(name == "host" || name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+            name == "transfer-encoding" || name == "upgrade")
+            continue;
+
+        auto value = field.value();
+        fields.push_back({std::move(name), std::string(value.data(), value.size())});
+    }
+
+    std::vector<nghttp2_nv> header_block;
+    for(auto& [name, value] : fields)
+        header_block.push_back({reinterpret_cast<uint8_t*>(name.data()), reinterpret_cast<uint8_t*>(value.data()),
+            name.size(), value.size(), NGHTTP2_NV_FLAG_NONE});
+
+    Stream stream(transport->get_executor());
+    stream.consumer = std::move(consumer);
+    stream.request_body = req.body();
+
+    nghttp2_priority_spec priority_spec;
+    nghttp2_priority_spec_init(&priority_spec, 0, getWeight(priority), 0);
+    nghttp2_data_provider body_provider;
+    body_provider.source.ptr = nullptr;
+    body_provider.read_callback = readRequestBody;
+
+    int32_t stream_id = nghttp2_submit_request(session, &priority_spec, header_block.data(), header_block.size(),
+        req.body().empty() ? nullptr : &body_provider, nullptr);
+    if(stream_id < 0)
+        throw std::runtime_error(std::string("http/2 request couldn't be sent: ") + nghttp2_strerror(stream_id));
+
+    streams.insert({stream_id, &stream});
+    requests_sent++;
+    scheduleFlush();
+
+    // if the coroutine is torn down without finishing, nothing may point at its stream afterwards
+    struct StreamGuard {
+        Http2Session* owner;
+        int32_t id;
+        ~StreamGuard() {
+            if(owner->streams.erase(id) && !owner->closed)
+                nghttp2_submit_rst_stream(owner->session, NGHTTP2_FLAG_NONE, id, NGHTTP2_CANCEL);
+        };
+    } guard{this, stream_id};
+
+    stream.done_timer.expires_at(net::steady_timer::time_point::max());
+    while(!stream.done){
+        boost::system::error_code ec;
+        co_await stream.done_timer.async_wait(net::redirect_error(net::use_awaitable, ec));
+    }
+
+    if(stream.error)
+        std::rethrow_exception(stream.error);
+    co_return std::move(stream.header);
+};
+
+net::awaitable<void> Http2Session::readLoop() {
+    std::shared_ptr<Http2Session> self = shared_from_this();
+    std::vector<uint8_t> buffer(16 * 1024);
+    boost::system::error_code ec;
+
+    while(!closed){
+        size_t read_size = co_await transport->async_read_some(net::buffer(buffer),
+            net::redirect_error(net::use_awaitable, ec));
+        if(ec)
+            break;
+
+        if(nghttp2_session_mem_recv(session, buffer.data(), read_size) < 0){
+            ec = boost::system::errc::make_error_code(boost::system::errc::protocol_error);
+            break;
+        }
+        // a GOAWAY was received and every stream it let finish has
+        if(!nghttp2_session_want_read(session) && !nghttp2_session_want_write(session)){
+            ec = net::error::eof;
+            break;
+        }
+        // settings acks, window updates and resets
+        scheduleFlush();
+    }
+    close(ec ? ec : net::error::eof);
+};
+
+void Http2Session::scheduleFlush() {
+    if(writing || closed)
+        return;
+
+    writing = true;
+    net::co_spawn(transport->get_executor(), [self = shared_from_this()](){
+        return self->flush();
+    }, net::detached);
+};
+
+net::awaitable<void> Http2Session::flush() {
+    try {
+        while(!closed){
+            // gathered into one write, frames are small and each write is a tls record
+            write_buffer.clear();
+            while(write_buffer.size() < limits.window_bytes){
+                const uint8_t* data;
+                ssize_t size = nghttp2_session_mem_send(session, &data);
+                if(size < 0)
+                    throw boost::system::system_error(boost::system::errc::make_error_code(boost::system::errc::protocol_error));
+                if(size == 0)
+                    break;
+                write_buffer.append(reinterpret_cast<const char*>(data), size);
+            }
+            if(write_buffer.empty())
+                break;
+
+            co_await net::async_write(*transport, net::buffer(write_buffer), net::use_awaitable);
+        }
+    } catch(const boost::system::system_error& error) {
+        close(error.code());
+    }
+    writing = false;
+};
+
+void Http2Session::close(boost::system::error_code error) {
+    if(closed)
+        return;
+    closed = true;
+
+    std::unordered_map<int32_t, Stream*> open_streams = std::move(streams);
+    streams.clear();
+    for(auto& [stream_id, stream] : open_streams){
+        stream->error = std::make_exception_ptr(boost::system::system_error(error));
+        stream->done = true;
+        stream->done_timer.cancel();
+    }
+
+    boost::system::error_code ignored;
+    transport->getSocket().close(ignored);
+};
+
+void Http2Session::resetStream(Stream& stream, int32_t stream_id, std::exception_ptr error) {
+    nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, stream_id, NGHTTP2_CANCEL);
+    stream.error = error;
+    stream.done = true;
+    stream.done_timer.cancel();
+    streams.erase(stream_id);
+    scheduleFlush();
+};
+
+int Http2Session::onHeader(nghttp2_session*, const nghttp2_frame* frame, const uint8_t* name,
+    size_t name_length, const uint8_t* value, size_t value_length, uint8_t, void* user_data) {
+    Http2Session* self = static_cast<Http2Session*>(user_data);
+    if(frame->hd.type != NGHTTP2_HEADERS)
+        return 0;
+    auto itr = self->streams.find(frame->hd.stream_id);
+    if(itr == self->streams.end())
+        return 0;
+
+    Stream& stream = *itr->second;
+    stream.header_bytes += name_length + value_length;
+    if(stream.header_bytes > self->limits.max_header_bytes){
+        self->resetStream(stream, frame->hd.stream_id,
+            std::make_exception_ptr(boost::system::system_error(http::error::header_limit)));
+        return 0;
+    }
+
+    std::string_view header_name(reinterpret_cast<const char*>(name), name_length);
+    std::string_view header_value(reinterpret_cast<const char*>(value), value_length);
+    if(header_name == ":status"){
+        // a 1xx comes before the real response, whose headers replace it
+        stream.header = {};
+        stream.header.version(20);
+        stream.header.result(std::stoi(std::string(header_value)));
+    } else if(!header_name.starts_with(':')) {
+        stream.header.insert(boost::beast::string_view(header_name.data(), header_name.size()),
+            boost::beast::string_view(header_value.data(), header_value.size()));
+    }
+    return 0;
+};
+
+int Http2Session::onDataChunk(nghttp2_session* session, uint8_t, int32_t stream_id,
+    const uint8_t* data, size_t length, void* user_data) {
+    Http2Session* self = static_cast<Http2Session*>(user_data);
+    // the consumer runs right here, by the time it returns the data is taken
+    nghttp2_session_consume(session, stream_id, length);
+
+    auto itr = self->streams.find(stream_id);
+    if(itr == self->streams.end())
+        return 0;
+
+    Stream& stream = *itr->second;
+    stream.body_bytes += length;
+    if(stream.body_bytes > self->limits.max_body_bytes){
+        self->resetStream(stream, stream_id, std::make_exception_ptr(boost::system::system_error(http::error::body_limit)));
+        return 0;
+    }
+
+    if(!stream.decoder){
+        auto content_encoding = stream.header[http::field::content_encoding];
+        stream.decoder.emplace(ContentDecoder::getEncoding(std::string_view(content_encoding.data(), content_encoding.size())));
+    }
+
+    stream.decoded.clear();
+    if(!stream.decoder->decode(std::string_view(reinterpret_cast<const char*>(data), length), stream.decoded)){
+        self->resetStream(stream, stream_id, std::make_exception_ptr(boost::system::system_error(
+            boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence))));
+        return 0;
+    }
+
+    try {
+        if(!stream.decoded.empty() && !stream.consumer(stream.decoded))
+            self->resetStream(stream, stream_id, nullptr);
+    } catch(...) {
+        // can't let it unwind through nghttp2
+        self->resetStream(stream, stream_id, std::current_exception());
+    }
+    return 0;
+};
+
+int Http2Session::onStreamClose(nghttp2_session*, int32_t stream_id, uint32_t error_code, void* user_data) {
+    Http2Session* self = static_cast<Http2Session*>(user_data);
+    auto itr = self->streams.find(stream_id);
+    if(itr == self->streams.end())
+        return 0;
+
+    Stream& stream = *itr->second;
+    if(error_code != NGHTTP2_NO_ERROR)
+        stream.error = std::make_exception_ptr(boost::system::system_error(net::error::connection_aborted,
+            std::string("http/2 stream reset, ") + nghttp2_http2_strerror(error_code)));
+    else if(stream.decoder && !stream.decoder->finish())
+        stream.error = std::make_exception_ptr(boost::system::system_error(
+            boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence)));
+
+    stream.done = true;
+    stream.done_timer.cancel();
+    self->streams.erase(itr);
+    return 0;
+};
+
+ssize_t Http2Session::readRequestBody(nghttp2_session*, int32_t stream_id, uint8_t* buffer,
+    size_t length, uint32_t* data_flags, nghttp2_data_source*, void* user_data) {
+    Http2Session* self = static_cast<Http2Session*>(user_data);
+    auto itr = self->streams.find(stream_id);
+    if(itr == self->streams.end())
+        return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+
+    Stream& stream = *itr->second;
+    size_t size = std::min(length, stream.request_body.size() - stream.request_body_offset);
+    std::memcpy(buffer, stream.request_body.data() + stream.request_body_offset, size);
+    stream.request_body_offset += size;
+    if(stream.request_body_offset == stream.request_body.size())
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    return size;
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/http.hpp>
+#include "ContentDecoder.h"
+#include "HttpTransport.h"
+#include "StreamedResponse.h"
+#include <cstdint>
+#include <memory>
+#include <nghttp2/nghttp2.h>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+
+//
+//  One Http/2 Connection To An Origin ( Negotiated Through Alpn ) That Every Request To It Shares.
+//  Each Request Is A Stream Of Its Own, Weighted By How Much The Page Needs It, And Its Body Is
+//  Decoded And Handed Over As The Data Frames Arrive. nghttp2 Does The Framing, Hpack And Flow
+//  Control, The Session Feeds It From The Socket And Writes Out Whatever It Has To Send
+//
+
+// how urgently a request's response is needed, the weight its stream gets against the others
+enum RequestPriority {
+    PriorityRenderBlocking, PriorityHigh, PriorityNormal, PriorityLow
+};
+
+struct Http2Settings {
+    uint32_t max_concurrent_streams = 100;
+    // per stream, how much the server may send before the consumer has taken it
+    uint32_t stream_window_bytes = 1024 * 1024;
+    // shared by all the streams of the connection
+    int32_t connection_window_bytes = 16 * 1024 * 1024;
+};
+
+// all of it runs on the executor of the transport, the http io thread
+class Http2Session : public std::enable_shared_from_this<Http2Session> {
+public:
+    Http2Session(std::unique_ptr<HttpTransport> tls_transport, const StreamLimits& stream_limits,
+        const Http2Settings& settings = {});
+    ~Http2Session();
+    Http2Session(const Http2Session&) = delete;
+    Http2Session& operator=(const Http2Session&) = delete;
+
+    // before the handshake, offers h2 with http/1.1 as the fallback
+    static void offerAlpn(SSL* ssl);
+    // after the handshake, whether the server picked h2
+    static bool isNegotiated(HttpTransport& transport);
+
+    // sends the connection preface and settings and starts reading
+    void start();
+    // false once the connection is gone, the server sent GOAWAY or the stream ids ran out
+    bool isUsable();
+
+    // sends req as a new stream and hands the decoded body to the consumer as it arrives. a
+    // consumer that returns false resets just its own stream, the connection carries on
+    net::awaitable<http::response_header<>> request(const http::request<http::string_body>& req,
+        RequestPriority priority, ChunkConsumer consumer);
+
+    size_t getOpenStreams() { return streams.size(); };
+    size_t getRequestsSent() { return requests_sent; };
+
+private:
+    struct Stream {
+        http::response_header<> header;
+        ChunkConsumer consumer;
+        std::optional<ContentDecoder> decoder;
+        std::string decoded;
+        size_t header_bytes = 0;
+        size_t body_bytes = 0;
+
+        std::string_view request_body;
+        size_t request_body_offset = 0;
+
+        bool done = false;
+        std::exception_ptr error;
+        net::steady_timer done_timer;
+
+        explicit Stream(const net::any_io_executor& executor): done_timer(executor) {};
+    };
+
+    std::unique_ptr<HttpTransport> transport;
+    nghttp2_session* session = nullptr;
+    StreamLimits limits;
+    Http2Settings session_settings;
+
+    // the streams live in the frames of the request coroutines waiting on them
+    std::unordered_map<int32_t, Stream*> streams;
+    std::string write_buffer;
+    bool writing = false;
+    bool closed = false;
+    size_t requests_sent = 0;
+
+    static int getWeight(RequestPriority priority);
+
+    net::awaitable<void> readLoop();
+    // writes out whatever nghttp2 has queued, one writer at a time
+    void scheduleFlush();
+    net::awaitable<void> flush();
+    // fails every open stream with error, the connection is done
+    void close(boost::system::error_code error);
+    // RST_STREAM, and the stream is done with error ( none when the consumer stopped it )
+    void resetStream(Stream& stream, int32_t stream_id, std::exception_ptr error);
+
+    static int onHeader(nghttp2_session* session, const nghttp2_frame* frame, const uint8_t* name,
+        size_t name_length, const uint8_t* value, size_t value_length, uint8_t flags, void* user_data);
+    static int onDataChunk(nghttp2_session* session, uint8_t flags, int32_t stream_id,
+        const uint8_t* data, size_t length, void* user_data);
+    static int onStreamClose(nghttp2_session* session, int32_t stream_id, uint32_t error_code,
+        void* user_data);
+    static ssize_t readRequestBody(nghttp2_session* session, int32_t stream_id, uint8_t* buffer,
+        size_t length, uint32_t* data_flags, nghttp2_data_source* source, void* user_data);
+};
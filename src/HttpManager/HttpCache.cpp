@@ -0,0 +1,454 @@
+#include "HttpCache.h"
+#include <algorithm>
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <cctype>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <openssl/evp.h>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+CacheBlobWriter::CacheBlobWriter(fs::path temp_path): path(std::move(temp_path)),
+    strea(path, std::ios::binary | std::ios::trunc), digest_ctx(EVP_MD_CTX_new()) {
+    EVP_DigestInit_ex(digest_ctx, EVP_sha256(), nullptr);
+};
+
+CacheBlobWriter::~CacheBlobWriter() {
+    EVP_MD_CTX_free(digest_ctx);
+    if(!taken){
+        strea.close();
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+};
+
+bool CacheBlobWriter::write(std::string_view chunk) {
+    EVP_DigestUpdate(digest_ctx, chunk.data(), chunk.size());
+    strea.write(chunk.data(), chunk.size());
+    written += chunk.size();
+    return strea.good();
+};
+
+std::string CacheBlobWriter::finish() {
+    strea.close();
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size = 0;
+    EVP_DigestFinal_ex(digest_ctx, digest, &digest_size);
+    return HttpCache::toHex(digest, digest_size);
+};
+
+bool CachedResponse::isFresh() const {
+    return !revalidate && HttpCache::now() < stored_at + fresh_for;
+};
+
+HttpCache::HttpCache(fs::path cache_dir, size_t max_bytes): root(std::move(cache_dir)),
+    blobs_dir(root / "blobs"), entries_dir(root / "entries"), transient_dir(root / "transient"),
+    max_cached_bytes(max_bytes) {
+    fs::create_directories(blobs_dir);
+    fs::create_directories(entries_dir);
+
+    std::error_code ec;
+    fs::remove_all(transient_dir, ec);
+    fs::create_directories(transient_dir);
+
+    loadIndex();
+};
+
+int64_t HttpCache::now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+};
+
+int64_t HttpCache::parseHttpDate(std::string_view date) {
+    // only the imf-fixdate form, the obsolete ones are long gone from real servers
+    std::tm time = {};
+    std::istringstream strea{std::string(date)};
+    strea >> std::get_time(&time, "%a, %d %b %Y %H:%M:%S");
+    if(strea.fail())
+        return -1;
+    return timegm(&time);
+};
+
+std::string HttpCache::sha256Hex(std::string_view data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size = 0;
+    EVP_Digest(data.data(), data.size(), digest, &digest_size, EVP_sha256(), nullptr);
+
+    return toHex(digest, digest_size);
+};
+
+std::string HttpCache::toHex(const unsigned char* data, size_t size) {
+    static constexpr char hex_digits[] = "0123456789abcdef";
+    std::string result(size * 2, '0');
+    for(size_t i = 0; i < size; i++){
+        result[i * 2] = hex_digits[data[i] >> 4];
+        result[i * 2 + 1] = hex_digits[data[i] & 0xF];
+    }
+    return result;
+};
+
+HttpCache::ResponsePolicy HttpCache::getPolicy(const http::response_header<>& res, int64_t current) {
+    ResponsePolicy policy;
+    std::string cache_control(res[http::field::cache_control]);
+    std::transform(cache_control.begin(), cache_control.end(), cache_control.begin(),
+        [](unsigned char c){ return std::tolower(c); });
+
+    int64_t max_age = -1;
+    size_t start = 0;
+    while(start <= cache_control.size()){
+        size_t end = std::min(cache_control.find(',', start), cache_control.size());
+        std::string_view directive(cache_control.data() + start, end - start);
+        while(!directive.empty() && std::isspace((unsigned char)directive.front())) directive.remove_prefix(1);
+        while(!directive.empty() && std::isspace((unsigned char)directive.back())) directive.remove_suffix(1);
+
+        // private is fine, this is the browser's own cache. s-maxage is for shared caches only
+        if(directive == "no-store")
+            policy.storable = false;
+        else if(directive == "no-cache")
+            policy.revalidate = true;
+        else if(directive.starts_with("max-age=")){
+            try { max_age = std::stoll(std::string(directive.substr(8))); } catch(...) { max_age = 0; }
+        }
+        start = end + 1;
+    }
+    if(res[http::field::vary] == "*")
+        policy.storable = false;
+
+    auto header = [&res](http::field field){
+        auto value = res[field];
+        return std::string_view(value.data(), value.size());
+    };
+
+    int64_t date = res.count(http::field::date) ? parseHttpDate(header(http::field::date)) : -1;
+    if(date < 0)
+        date = current;
+
+    if(max_age >= 0)
+        policy.fresh_for = max_age;
+    else if(res.count(http::field::expires))
+        policy.fresh_for = std::max<int64_t>(parseHttpDate(header(http::field::expires)) - date, 0);
+    else if(res.count(http::field::last_modified)){
+        // the usual heuristic, a tenth of how long it had gone unchanged, at most a day
+        int64_t last_modified = parseHttpDate(header(http::field::last_modified));
+        if(last_modified >= 0)
+            policy.fresh_for = std::clamp<int64_t>((date - last_modified) / 10, 0, 24 * 60 * 60);
+    }
+
+    if(res.count(http::field::age)){
+        try { policy.fresh_for -= std::stoll(std::string(res[http::field::age])); } catch(...) {}
+    }
+
+    // nothing to gain from an entry that is stale right away and can't be revalidated
+    bool has_validators = res.count(http::field::etag) || res.count(http::field::last_modified);
+    if(policy.fresh_for <= 0 && !has_validators)
+        policy.storable = false;
+    return policy;
+};
+
+std::optional<CachedResponse> HttpCache::lookup(const std::string& url) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    auto itr = index.find(url);
+    if(itr == index.end()){
+        misses++;
+        return std::nullopt;
+    }
+
+    // someone cleaned the directory under us
+    if(!fs::exists(itr->second.response.body_path)){
+        eraseEntry(url);
+        misses++;
+        return std::nullopt;
+    }
+
+    lru.splice(lru.begin(), lru, itr->second.lru_itr);
+    if(itr->second.response.isFresh())
+        hits++;
+    return itr->second.response;
+};
+
+void HttpCache::addValidators(http::request<http::string_body>& req, const CachedResponse& cached) {
+    if(!cached.etag.empty())
+        req.set(http::field::if_none_match, cached.etag);
+    if(!cached.last_modified.empty())
+        req.set(http::field::if_modified_since, cached.last_modified);
+};
+
+std::optional<std::string> HttpCache::store(const std::string& url,
+    const http::response_header<>& res, std::string_view body, std::string_view extension) {
+    int64_t current = now();
+    ResponsePolicy policy = getPolicy(res, current);
+
+    std::lock_guard<std::mutex> lock(cache_mut);
+    if(res.result() != http::status::ok || !policy.storable){
+        if(index.contains(url))
+            eraseEntry(url);
+        return std::nullopt;
+    }
+
+    std::string blob_name = sha256Hex(body);
+    if(!extension.empty())
+        blob_name += "." + std::string(extension);
+    fs::path blob_path = blobs_dir / blob_name;
+
+    // before looking at the blobs, the old entry may hold the only reference to this very body
+    if(index.contains(url))
+        eraseEntry(url);
+
+    // same contents, same file, whichever url brought them
+    if(!blobs.contains(blob_path.string()))
+        writeFile(blob_path, body);
+
+    insertStored(url, res, policy, blob_path, body.size(), current);
+    return blob_path.string();
+};
+
+std::unique_ptr<CacheBlobWriter> HttpCache::createBlobWriter() {
+    boost::uuids::random_generator guid_gen;
+    return std::make_unique<CacheBlobWriter>(transient_dir / (boost::uuids::to_string(guid_gen()) + ".part"));
+};
+
+std::string HttpCache::storeStreamed(const std::string& url, const http::response_header<>& res,
+    CacheBlobWriter& writer, std::string_view extension) {
+    int64_t current = now();
+    ResponsePolicy policy = getPolicy(res, current);
+    std::string digest = writer.finish();
+    std::string suffix = extension.empty() ? "" : "." + std::string(extension);
+
+    std::lock_guard<std::mutex> lock(cache_mut);
+    if(index.contains(url))
+        eraseEntry(url);
+
+    writer.taken = true;
+    if(res.result() != http::status::ok || !policy.storable){
+        fs::path transient_path = transient_dir / (writer.path.stem().string() + suffix);
+        fs::rename(writer.path, transient_path);
+        return transient_path.string();
+    }
+
+    fs::path blob_path = blobs_dir / (digest + suffix);
+    if(blobs.contains(blob_path.string()))
+        fs::remove(writer.path);
+    else
+        fs::rename(writer.path, blob_path);
+
+    insertStored(url, res, policy, blob_path, writer.size(), current);
+    return blob_path.string();
+};
+
+void HttpCache::insertStored(const std::string& url, const http::response_header<>& res,
+    const ResponsePolicy& policy, const fs::path& blob_path, size_t size, int64_t stored_at) {
+    CachedResponse cached;
+    cached.url = url;
+    cached.body_path = blob_path.string();
+    cached.content_type = std::string(res[http::field::content_type]);
+    cached.etag = std::string(res[http::field::etag]);
+    cached.last_modified = std::string(res[http::field::last_modified]);
+    cached.stored_at = stored_at;
+    cached.fresh_for = policy.fresh_for;
+    cached.revalidate = policy.revalidate;
+    cached.size = size;
+
+    writeEntryFile(cached);
+    insertEntry(std::move(cached));
+    evictToBudget(url);
+};
+
+std::string HttpCache::storeTransient(std::string_view body, std::string_view extension) {
+    boost::uuids::random_generator guid_gen;
+    std::string file_name = boost::uuids::to_string(guid_gen());
+    if(!extension.empty())
+        file_name += "." + std::string(extension);
+
+    fs::path path = transient_dir / file_name;
+    writeFile(path, body);
+    return path.string();
+};
+
+std::optional<CachedResponse> HttpCache::revalidated(const std::string& url,
+    const http::response_header<>& res) {
+    int64_t current = now();
+    ResponsePolicy policy = getPolicy(res, current);
+
+    std::lock_guard<std::mutex> lock(cache_mut);
+    auto itr = index.find(url);
+    if(itr == index.end())
+        return std::nullopt;
+
+    // a 304 carries the headers the 200 would have, the body stays what we have
+    CachedResponse& cached = itr->second.response;
+    cached.stored_at = current;
+    cached.fresh_for = policy.fresh_for;
+    cached.revalidate = policy.revalidate;
+    if(res.count(http::field::etag))
+        cached.etag = std::string(res[http::field::etag]);
+    if(res.count(http::field::last_modified))
+        cached.last_modified = std::string(res[http::field::last_modified]);
+
+    lru.splice(lru.begin(), lru, itr->second.lru_itr);
+    writeEntryFile(cached);
+    revalidations++;
+    return cached;
+};
+
+void HttpCache::remove(const std::string& url) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    if(index.contains(url))
+        eraseEntry(url);
+};
+
+void HttpCache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    while(!lru.empty()){
+        std::string url = lru.back();
+        eraseEntry(url);
+    }
+};
+
+std::string HttpCache::readBody(const CachedResponse& cached) {
+    std::ifstream strea(cached.body_path, std::ios::binary);
+    std::string body(cached.size, 0);
+    strea.read(body.data(), body.size());
+    body.resize(strea.gcount());
+    return body;
+};
+
+size_t HttpCache::getHits() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return hits;
+};
+
+size_t HttpCache::getRevalidations() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return revalidations;
+};
+
+size_t HttpCache::getMisses() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return misses;
+};
+
+size_t HttpCache::sizeInBytes() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return total_bytes;
+};
+
+fs::path HttpCache::getEntryPath(const std::string& url) {
+    return entries_dir / sha256Hex(url);
+};
+
+void HttpCache::writeFile(const fs::path& path, std::string_view contents) {
+    // written aside and renamed, a crash never leaves a half written file under the real name
+    fs::path temp_path = path;
+    temp_path += ".part";
+    {
+        std::ofstream strea(temp_path, std::ios::binary | std::ios::trunc);
+        strea.write(contents.data(), contents.size());
+    }
+    fs::rename(temp_path, path);
+};
+
+void HttpCache::writeEntryFile(const CachedResponse& cached) {
+    // one field per line, none of them can hold a newline since they all came out of headers
+    std::string contents = cached.url + "\n" + cached.body_path + "\n" + cached.content_type + "\n" +
+        cached.etag + "\n" + cached.last_modified + "\n" + std::to_string(cached.stored_at) + "\n" +
+        std::to_string(cached.fresh_for) + "\n" + std::to_string(cached.revalidate) + "\n" +
+        std::to_string(cached.size) + "\n";
+    writeFile(getEntryPath(cached.url), contents);
+};
+
+std::optional<CachedResponse> HttpCache::readEntryFile(const fs::path& entry_path) {
+    std::ifstream strea(entry_path);
+    CachedResponse cached;
+    std::string stored_at, fresh_for, revalidate, size;
+
+    if(!std::getline(strea, cached.url) || !std::getline(strea, cached.body_path) ||
+        !std::getline(strea, cached.content_type) || !std::getline(strea, cached.etag) ||
+        !std::getline(strea, cached.last_modified) || !std::getline(strea, stored_at) ||
+        !std::getline(strea, fresh_for) || !std::getline(strea, revalidate) || !std::getline(strea, size))
+        return std::nullopt;
+
+    try {
+        cached.stored_at = std::stoll(stored_at);
+        cached.fresh_for = std::stoll(fresh_for);
+        cached.revalidate = revalidate == "1";
+        cached.size = std::stoull(size);
+    } catch(...) {
+        return std::nullopt;
+    }
+    return cached;
+};
+
+void HttpCache::loadIndex() {
+    std::vector<CachedResponse> loaded;
+    std::error_code ec;
+
+    for(auto& file : fs::directory_iterator(entries_dir, ec)){
+        std::optional<CachedResponse> cached = readEntryFile(file.path());
+        if(!cached || !fs::exists(cached->body_path) || file.path().extension() == ".part"){
+            fs::remove(file.path(), ec);
+            continue;
+        }
+        loaded.push_back(std::move(*cached));
+    }
+
+    // no access times on disk, the newest stored entries count as the most recently used
+    std::sort(loaded.begin(), loaded.end(), [](const CachedResponse& lhs, const CachedResponse& rhs){
+        return lhs.stored_at < rhs.stored_at;
+    });
+
+    std::lock_guard<std::mutex> lock(cache_mut);
+    for(auto& cached : loaded)
+        insertEntry(std::move(cached));
+
+    // bodies no entry points at anymore
+    for(auto& file : fs::directory_iterator(blobs_dir, ec))
+        if(!blobs.contains(file.path().string()))
+            fs::remove(file.path(), ec);
+
+    evictToBudget("");
+};
+
+void HttpCache::insertEntry(CachedResponse cached) {
+    BlobInfo& blob = blobs[cached.body_path];
+    if(blob.refs == 0){
+        blob.size = cached.size;
+        total_bytes += cached.size;
+    }
+    blob.refs++;
+
+    lru.push_front(cached.url);
+    std::string url = cached.url;
+    index.insert_or_assign(std::move(url), IndexEntry{std::move(cached), lru.begin()});
+};
+
+void HttpCache::eraseEntry(const std::string& url) {
+    auto itr = index.find(url);
+    std::error_code ec;
+    fs::remove(getEntryPath(url), ec);
+    releaseBlob(itr->second.response.body_path);
+    std::list<std::string>::iterator lru_itr = itr->second.lru_itr;
+    index.erase(itr);
+    lru.erase(lru_itr);
+};
+
+void HttpCache::releaseBlob(const std::string& body_path) {
+    auto itr = blobs.find(body_path);
+    if(itr == blobs.end() || --itr->second.refs > 0)
+        return;
+
+    total_bytes -= itr->second.size;
+    std::error_code ec;
+    fs::remove(body_path, ec);
+    blobs.erase(itr);
+};
+
+void HttpCache::evictToBudget(const std::string& keep_url) {
+    while(total_bytes > max_cached_bytes && !lru.empty() && lru.back() != keep_url){
+        std::string victim = lru.back();
+        eraseEntry(victim);
+    }
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <openssl/evp.h>
+
+namespace http = boost::beast::http;
+
+//
+//  A Private ( Browser Side ) Http Cache In The Spirit Of Rfc 9111. Bodies Are Stored Once Under
+//  The Sha-256 Of Their Contents, The Index Maps Each Url To Its Body, Validators And Freshness
+//  And Lives In Memory, Backed By One Small Metadata File Per Url So It Survives A Restart
+//
+
+struct CachedResponse {
+    std::string url;
+    std::string body_path;
+    std::string content_type;
+    std::string etag;
+    std::string last_modified;
+    int64_t stored_at = 0;
+    // seconds after stored_at the response can be used without asking the server
+    int64_t fresh_for = 0;
+    // no-cache, always revalidate even while fresh
+    bool revalidate = false;
+    size_t size = 0;
+
+    bool isFresh() const;
+    bool hasValidators() const { return !etag.empty() || !last_modified.empty(); };
+};
+
+// a body on its way to disk in chunks, hashed as it's written so it can be stored under its
+// contents without ever being held in memory. the file is removed unless the cache takes it
+class CacheBlobWriter {
+public:
+    explicit CacheBlobWriter(std::filesystem::path temp_path);
+    ~CacheBlobWriter();
+    CacheBlobWriter(const CacheBlobWriter&) = delete;
+    CacheBlobWriter& operator=(const CacheBlobWriter&) = delete;
+
+    bool write(std::string_view chunk);
+    size_t size() const { return written; };
+
+private:
+    friend class HttpCache;
+
+    std::filesystem::path path;
+    std::ofstream strea;
+    EVP_MD_CTX* digest_ctx;
+    size_t written = 0;
+    bool taken = false;
+
+    // closes the file, the hex sha-256 of everything written
+    std::string finish();
+};
+
+class HttpCache {
+public:
+    explicit HttpCache(std::filesystem::path cache_dir = "./Config/HttpCache",
+        size_t max_bytes = 256 * 1024 * 1024);
+
+    std::optional<CachedResponse> lookup(const std::string& url);
+    // If-None-Match / If-Modified-Since for a stale entry
+    static void addValidators(http::request<http::string_body>& req, const CachedResponse& cached);
+
+    // stores a 200 if its headers allow it and returns where the body is on disk,
+    // a response that may not be stored also drops whatever was stored for the url
+    std::optional<std::string> store(const std::string& url, const http::response_header<>& res,
+        std::string_view body, std::string_view extension = "");
+    // for bodies that need a path but can't be cached, wiped on the next start
+    std::string storeTransient(std::string_view body, std::string_view extension = "");
+
+    std::unique_ptr<CacheBlobWriter> createBlobWriter();
+    // store for a streamed body, always gives back a path, a transient one if it can't be cached
+    std::string storeStreamed(const std::string& url, const http::response_header<>& res,
+        CacheBlobWriter& writer, std::string_view extension = "");
+    // a 304 for a stored entry, refreshes its freshness from the new headers.
+    // nullopt if the entry was evicted while the request was in flight
+    std::optional<CachedResponse> revalidated(const std::string& url, const http::response_header<>& res);
+
+    void remove(const std::string& url);
+    void clear();
+
+    static std::string readBody(const CachedResponse& cached);
+    // unix seconds, what stored_at and the http dates are in
+    static int64_t now();
+
+    size_t getHits();
+    size_t getRevalidations();
+    size_t getMisses();
+    size_t sizeInBytes();
+
+private:
+    friend class CacheBlobWriter;
+
+    struct IndexEntry {
+        CachedResponse response;
+        std::list<std::string>::iterator lru_itr;
+    };
+    struct BlobInfo {
+        size_t size;
+        size_t refs;
+    };
+    struct ResponsePolicy {
+        bool storable = true;
+        bool revalidate = false;
+        int64_t fresh_for = 0;
+    };
+
+    std::filesystem::path root;
+    std::filesystem::path blobs_dir;
+    std::filesystem::path entries_dir;
+    std::filesystem::path transient_dir;
+    size_t max_cached_bytes;
+
+    std::mutex cache_mut;
+    std::unordered_map<std::string, IndexEntry> index;
+    // most recently used at the front
+    std::list<std::string> lru;
+    std::unordered_map<std::string, BlobInfo> blobs;
+    size_t total_bytes = 0;
+    size_t hits = 0;
+    size_t revalidations = 0;
+    size_t misses = 0;
+
+    static ResponsePolicy getPolicy(const http::response_header<>& res, int64_t now);
+    static int64_t parseHttpDate(std::string_view date);
+    static std::string sha256Hex(std::string_view data);
+    static std::string toHex(const unsigned char* data, size_t size);
+
+    void loadIndex();
+    void writeEntryFile(const CachedResponse& cached);
+    std::optional<CachedResponse> readEntryFile(const std::filesystem::path& entry_path);
+    std::filesystem::path getEntryPath(const std::string& url);
+    static void writeFile(const std::filesystem::path& path, std::string_view contents);
+
+    // all of these expect cache_mut to be held
+    void insertStored(const std::string& url, const http::response_header<>& res, const ResponsePolicy& policy,
+        const std::filesystem::path& blob_path, size_t size, int64_t stored_at);
+    void insertEntry(CachedResponse cached);
+    void eraseEntry(const std::string& url);
+    void releaseBlob(const std::string& body_path);
+    void evictToBudget(const std::string& keep_url);
+};
@@ -1,10 +1,13 @@
 #include "HttpManager.h"
+#include "../Concurrency/ThreadPool.h"
 #include <boost/beast/http/buffer_body.hpp>
 #include <boost/beast/http/dynamic_body.hpp>
 #include <boost/beast/http/field.hpp>
 #include <boost/beast/http/file_body.hpp>
 #include <boost/uuid/name_generator.hpp>
 #include <boost/uuid/random_generator.hpp>
+#include <algorithm>
+#include <atomic>
 #include <format>
 #include <openssl/ssl.h>
 #include <openssl/tls1.h>
@@ -16,6 +19,8 @@
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 
 namespace fs = std::filesystem;
 
@@ -24,7 +29,31 @@ std::vector<std::string> HttpExposer::memory_resources_paths = {};
 
 HttpManager::HttpManager(net::io_context& io_context, ssl::context& ssl_context,
         tcp::resolver& our_resolver): io_ctx(io_context), ssl_ctx(ssl_context),
-        resolver(our_resolver) {
+        resolver(our_resolver), async_resolver(async_io_ctx), async_work(net::make_work_guard(async_io_ctx)) {
+    tls_session_cache.attach(ssl_ctx);
+    async_thread = std::thread([this](){ async_io_ctx.run(); });
+};
+
+HttpManager::~HttpManager() {
+    async_work.reset();
+    async_io_ctx.stop();
+    if(async_thread.joinable())
+        async_thread.join();
+
+    // queued disk jobs skip their work and only hand their coroutine back, to be dropped below
+    {
+        std::unique_lock<std::mutex> lock(disk_jobs->mut);
+        disk_jobs->accepting = false;
+        disk_jobs->idle.wait(lock, [this]{ return disk_jobs->pending == 0; });
+    }
+
+    // the coroutines still suspended never finish their flights, whoever joined them gets an error
+    get_flights.failAll(std::make_exception_ptr(std::runtime_error("http manager shut down")));
+    // destroys every pending handler, and with them the coroutine frames. their leases go back to
+    // the pool and their streams out of the sessions while both still exist
+    async_io_ctx.shutdown();
+    async_connection_pool.closeIdle();
+    http2_origins.clear();
 };
 
 UrlInfo HttpManager::getUrlInfoByUrl(std::string url){
@@ -52,7 +81,152 @@ UrlInfo HttpManager::getUrlInfoByUrl(std::string url){
         host_name = url;
     }
 
-    return {schema, host_name, path};
+    // host:port, an ipv6 literal keeps its colons inside the brackets
+    std::string port;
+    auto port_pos = host_name.rfind(':');
+    if(port_pos != std::string::npos && host_name.find(']', port_pos) == std::string::npos){
+        port = host_name.substr(port_pos + 1);
+        host_name = host_name.substr(0, port_pos);
+    }
+    if(host_name.starts_with('[') && host_name.ends_with(']'))
+        host_name = host_name.substr(1, host_name.size() - 2);
+
+    return {schema, host_name, path, port};
+};
+
+std::unique_ptr<HttpTransport> HttpManager::openConnection(const UrlInfo& url_info){
+    std::vector<tcp::endpoint> endpoints = dns_cache.resolve(url_info.host_name, url_info.getService());
+    tcp::socket socket = HappyEyeballs::connect(io_ctx, endpoints);
+    if(!url_info.isTls())
+        return std::make_unique<HttpTransport>(std::move(socket));
+
+    SslStream sock(std::move(socket), ssl_ctx);
+    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
+
+    tls_session_cache.offerSession(sock.native_handle(), url_info.host_name);
+    sock.handshake(SslStream::client);
+    tls_session_cache.recordHandshake(sock.native_handle());
+
+    return std::make_unique<HttpTransport>(std::move(sock));
+};
+
+http::request<http::string_body> HttpManager::makeRequest(http::verb method, const UrlInfo& url_info){
+    http::request<http::string_body> req(method, url_info.path, 11);
+    req.set(beast::http::field::host, url_info.getAuthority());
+    req.set(http::field::user_agent, "MyBrowser (Linux)");
+    // bodies are decoded chunk by chunk as they're read, see DecodedStringBody
+    req.set(http::field::accept_encoding, std::string(ContentDecoder::accept_encoding));
+    req.keep_alive(true);
+    return req;
+};
+
+bool HttpManager::isRetryable(const http::request<http::string_body>& req){
+    return req.method() == http::verb::get || req.method() == http::verb::head;
+};
+
+template<class ResponseBody>
+http::response<ResponseBody> HttpManager::performRequest(http::request<http::string_body>& req,
+    const UrlInfo& url_info){
+    std::string host_key = url_info.schem + "://" + url_info.getAuthority();
+    req.prepare_payload();
+
+    for(int attempt = 0; ; attempt++){
+        ConnectionLease connection(connection_pool, host_key);
+        bool reused = connection->stream != nullptr;
+
+        try {
+            if(!reused)
+                connection->stream = openConnection(url_info);
+
+            http::write(*connection->stream, req);
+
+            beast::flat_buffer flat_buff;
+            http::response_parser<ResponseBody> parser;
+            parser.header_limit(stream_limits.max_header_bytes);
+            parser.body_limit(stream_limits.max_body_bytes);
+            http::read(*connection->stream, flat_buff, parser);
+
+            connection.release(parser.keep_alive());
+            return parser.release();
+        } catch(const boost::system::system_error&) {
+            // the server may drop an idle connection right between the staleness check and the write
+            if(!reused || attempt > 0 || !isRetryable(req))
+                throw;
+        }
+    }
+};
+
+http::response_header<> HttpManager::performStreamingRequest(http::request<http::string_body>& req,
+    const UrlInfo& url_info, const ChunkConsumer& consumer){
+    std::string host_key = url_info.schem + "://" + url_info.getAuthority();
+    req.prepare_payload();
+
+    for(int attempt = 0; ; attempt++){
+        ConnectionLease connection(connection_pool, host_key);
+        bool reused = connection->stream != nullptr;
+        bool body_started = false;
+
+        try {
+            if(!reused)
+                connection->stream = openConnection(url_info);
+
+            http::write(*connection->stream, req);
+
+            beast::flat_buffer flat_buff;
+            StreamedResponse streamed(stream_limits);
+            http::read_header(*connection->stream, flat_buff, streamed.getParser());
+            streamed.startBody();
+            body_started = true;
+
+            bool completed = true;
+            while(!streamed.isDone()){
+                streamed.prepareWindow();
+                boost::system::error_code ec;
+                http::read(*connection->stream, flat_buff, streamed.getParser(), ec);
+                // need_buffer just means the window is full
+                if(ec && ec != http::error::need_buffer)
+                    throw boost::system::system_error(ec);
+                if(!streamed.deliver(consumer)){
+                    completed = false;
+                    break;
+                }
+            }
+            if(completed)
+                streamed.finish();
+
+            // a response left half read can't carry the next request
+            connection.release(completed && streamed.getParser().keep_alive());
+            return streamed.getParser().get().base();
+        } catch(const boost::system::system_error&) {
+            // once the consumer has seen part of the body a retry would hand it the start again
+            if(!reused || attempt > 0 || !isRetryable(req) || body_started)
+                throw;
+        }
+    }
+};
+
+http::response_header<> HttpManager::streamLocalFile(const std::string& path, const ChunkConsumer& consumer,
+    size_t window_bytes){
+    std::ifstream strea(path, std::ios::binary);
+    std::vector<char> window(window_bytes);
+    while(strea){
+        strea.read(window.data(), window.size());
+        if(strea.gcount() > 0 && !consumer(std::string_view(window.data(), strea.gcount())))
+            break;
+    }
+
+    http::response_header<> res;
+    res.result(http::status::ok);
+    return res;
+};
+
+http::response_header<> HttpManager::streamRequest(std::string url, ChunkConsumer consumer){
+    if(fs::exists(url))
+        return streamLocalFile(url, consumer, stream_limits.window_bytes);
+
+    UrlInfo url_info = getUrlInfoByUrl(url);
+    auto req = makeRequest(http::verb::get, url_info);
+    return performStreamingRequest(req, url_info, consumer);
 };
 
 std::string HttpManager::getRequest(std::string url){
@@ -70,146 +244,532 @@ std::string HttpManager::getRequest(std::string url){
         return str;
     };
 
-    UrlInfo url_info = getUrlInfoByUrl(url);
-    std::cout << url_info.host_name << url_info.path << url_info.schem;
-    ssl::stream<tcp::socket> sock(io_ctx, ssl_ctx);
+    return fetchCached(url, false);
+};
 
-    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
-    auto result = resolver.resolve(url_info.host_name, url_info.schem);
-    net::connect(sock.lowest_layer(), result);
-    sock.handshake(ssl::stream<tcp::socket>::client);
+std::string HttpManager::getImage(std::string url) {
 
-    http::request<http::string_body> req(http::verb::get, url_info.path, 11);
-    req.set(beast::http::field::host, url_info.host_name);
-    req.set(http::field::user_agent, "MyBrowser (Linux)");
+    if(fs::exists(url)){
+        return url;
+    };
 
-    http::write(sock, req);
+    return fetchCached(url, true);
+};
+
+std::string HttpManager::getFlightKey(const std::string& url, bool want_path) {
+    // a path and a body aren't interchangeable, getImage and getRequest of one url are two flights
+    return (want_path ? "path " : "body ") + url;
+};
 
-    beast::flat_buffer flat_buff;
-    http::response<http::string_body> res;
+std::string HttpManager::fetchCached(const std::string& url, bool want_path) {
+    std::optional<CachedResponse> cached = http_cache.lookup(url);
+    if(cached && cached->isFresh())
+        return want_path ? cached->body_path : HttpCache::readBody(*cached);
+
+    std::string key = getFlightKey(url, want_path);
+    if(std::shared_ptr<SingleFlight::Flight> flight = get_flights.join(key))
+        return get_flights.wait(flight);
+
+    std::string result;
+    try {
+        result = fetchFromOrigin(url, want_path, std::move(cached));
+    } catch(...) {
+        get_flights.finish(key, std::current_exception(), "");
+        throw;
+    }
+    get_flights.finish(key, nullptr, result);
+    return result;
+};
 
-    http::read(sock,flat_buff, res);
-    sock.lowest_layer().close();
-    return res.body();
+std::string HttpManager::fetchFromOrigin(const std::string& url, bool want_path, std::optional<CachedResponse> cached) {
+    UrlInfo url_info = getUrlInfoByUrl(url);
 
+    for(;;){
+        auto req = makeRequest(http::verb::get, url_info);
+        if(cached)
+            HttpCache::addValidators(req, *cached);
+
+        std::optional<std::string> result;
+        if(want_path){
+            // straight to a cache file a window at a time, a video never sits in memory whole
+            std::unique_ptr<CacheBlobWriter> writer = http_cache.createBlobWriter();
+            auto res = performStreamingRequest(req, url_info, [&writer](std::string_view chunk){
+                return writer->write(chunk);
+            });
+            result = completeGet(url, res, nullptr, writer.get());
+        } else {
+            auto res = performRequest<DecodedStringBody>(req, url_info);
+            result = completeGet(url, res.base(), &res.body(), nullptr);
+        }
+
+        if(result)
+            return std::move(*result);
+        cached.reset();
+    }
 };
 
-std::string HttpManager::getImage(std::string url) {
+std::optional<std::string> HttpManager::completeGet(const std::string& url,
+    const http::response_header<>& res, std::string* body, CacheBlobWriter* writer) {
+    if(res.result() == http::status::not_modified){
+        std::optional<CachedResponse> refreshed = http_cache.revalidated(url, res);
+        if(!refreshed)
+            return std::nullopt;
+        return writer ? refreshed->body_path : HttpCache::readBody(*refreshed);
+    }
 
-    if(fs::exists(url)){
-        return url;
-    };
+    if(body){
+        http_cache.store(url, res, *body);
+        return std::move(*body);
+    }
+
+    std::string content_type(res.at(http::field::content_type));
+    std::string_view ext = response_formats.at(content_type);
+    return http_cache.storeStreamed(url, res, *writer, ext);
+};
 
+std::string HttpManager::postRequest(std::string url, std::string_view body, std::string content_type){
     UrlInfo url_info = getUrlInfoByUrl(url);
-    std::cout << url_info.host_name << url_info.path << url_info.schem;
-    ssl::stream<tcp::socket> sock(io_ctx, ssl_ctx);
 
-    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
-    auto result = resolver.resolve(url_info.host_name, url_info.schem);
-    net::connect(sock.lowest_layer(), result);
-    sock.handshake(ssl::stream<tcp::socket>::client);
+    auto req = makeRequest(http::verb::post, url_info);
+    req.set(http::field::content_type, content_type);
+    req.body() = body;
 
-    http::request<http::string_body> req(http::verb::get, url_info.path, 11);
-    req.set(beast::http::field::host, url_info.host_name);
-    req.set(http::field::user_agent, "MyBrowser (Linux)");
+    return performRequest<DecodedStringBody>(req, url_info).body();
+};
+std::string HttpManager::putRequest(std::string url, std::string_view body, std::string content_type){
+    UrlInfo url_info = getUrlInfoByUrl(url);
 
-    http::write(sock, req);
+    auto req = makeRequest(http::verb::put, url_info);
+    req.set(http::field::content_type, content_type);
+    req.body() = body;
+
+    return performRequest<DecodedStringBody>(req, url_info).body();
+};
+std::string HttpManager::deleteRequest(std::string url){
+    UrlInfo url_info = getUrlInfoByUrl(url);
+
+    auto req = makeRequest(http::verb::delete_, url_info);
+    return performRequest<DecodedStringBody>(req, url_info).body();
+};
 
-    beast::flat_buffer flat_buff;
-    http::response<http::dynamic_body> res;
+net::awaitable<std::unique_ptr<PooledConnection>> HttpManager::acquireConnectionAsync(std::string host_key){
+    for(;;){
+        auto slot_freed = std::make_shared<net::steady_timer>(async_io_ctx, net::steady_timer::time_point::max());
+        // weak, the pool outlives the io context and a waiter can outlive the coroutine that left it
+        std::weak_ptr<net::steady_timer> waiter = slot_freed;
+        std::function<void()> wake = [this, waiter]{
+            net::post(async_io_ctx, [waiter]{
+                if(auto timer = waiter.lock())
+                    timer->cancel();
+            });
+        };
+        std::unique_ptr<PooledConnection> connection = async_connection_pool.tryAcquire(host_key, std::move(wake));
+        if(connection)
+            co_return connection;
+
+        boost::system::error_code ec;
+        co_await slot_freed->async_wait(net::redirect_error(net::use_awaitable, ec));
+    }
+};
+
+net::awaitable<std::unique_ptr<HttpTransport>> HttpManager::openConnectionAsync(UrlInfo url_info, bool offer_http2){
+    std::string service = url_info.getService();
+    std::optional<std::vector<tcp::endpoint>> endpoints = dns_cache.lookup(url_info.host_name, service);
+    if(!endpoints && dns_cache.hasCustomResolver())
+        endpoints = dns_cache.resolve(url_info.host_name, service);
+    if(!endpoints){
+        try {
+            auto results = co_await async_resolver.async_resolve(url_info.host_name, service, net::use_awaitable);
+            endpoints = dns_cache.store(url_info.host_name, service, results);
+        } catch(const boost::system::system_error& error) {
+            dns_cache.storeFailure(url_info.host_name, service, error.code());
+            throw;
+        }
+    }
+    tcp::socket socket = co_await HappyEyeballs::connect(*endpoints);
+    if(!url_info.isTls())
+        co_return std::make_unique<HttpTransport>(std::move(socket));
 
-    http::read(sock,flat_buff, res);
-    
-    std::string content_type = res.at(http::field::content_type);
-    std::string ext(response_formats.at(content_type));
+    SslStream sock(std::move(socket), ssl_ctx);
+    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
+    if(offer_http2)
+        Http2Session::offerAlpn(sock.native_handle());
 
-    boost::uuids::random_generator guid_gen;
-    boost::uuids::uuid file_uuid = guid_gen();
-    std::string file_name = boost::uuids::to_string(file_uuid);
+    tls_session_cache.offerSession(sock.native_handle(), url_info.host_name);
+    co_await sock.async_handshake(SslStream::client, net::use_awaitable);
+    tls_session_cache.recordHandshake(sock.native_handle());
 
-    std::ofstream strea(std::format("/tmp/{}.{}", file_name, ext), std::ios::binary);
+    co_return std::make_unique<HttpTransport>(std::move(sock));
+};
 
-    for(const auto& buf : res.body().data()){
-        strea.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+net::awaitable<std::shared_ptr<Http2Session>> HttpManager::getHttp2Session(const UrlInfo& url_info,
+    std::unique_ptr<HttpTransport>& http1_transport, bool& reused){
+    std::string host_key = url_info.schem + "://" + url_info.getAuthority();
+
+    for(;;){
+        if(http1_origins.contains(host_key))
+            co_return nullptr;
+
+        // never erased, so the reference outlives the awaits below
+        Http2Origin& origin = http2_origins[host_key];
+        if(origin.session && origin.session->isUsable()){
+            reused = true;
+            co_return origin.session;
+        }
+        if(!origin.connecting)
+            break;
+
+        // the handshake in progress answers whether it's h2, racing it would just open more connections
+        std::shared_ptr<net::steady_timer> connected = origin.connected;
+        boost::system::error_code ec;
+        co_await connected->async_wait(net::redirect_error(net::use_awaitable, ec));
     }
 
-    strea.close();
+    Http2Origin& origin = http2_origins[host_key];
+    origin.session.reset();
+    origin.connecting = true;
+    origin.connected = std::make_shared<net::steady_timer>(async_io_ctx, net::steady_timer::time_point::max());
+
+    std::unique_ptr<HttpTransport> transport;
+    try {
+        transport = co_await openConnectionAsync(url_info, true);
+    } catch(const boost::system::system_error&) {
+        // the ones waiting try for themselves
+        origin.connecting = false;
+        origin.connected->cancel();
+        throw;
+    }
+    origin.connecting = false;
+    origin.connected->cancel();
 
-    sock.lowest_layer().close();
-    std::string path_name = std::format("/tmp/{}.{}", file_name, ext);
-    return path_name;
+    if(!Http2Session::isNegotiated(*transport)){
+        http1_origins.insert(host_key);
+        http1_transport = std::move(transport);
+        co_return nullptr;
+    }
+
+    origin.session = std::make_shared<Http2Session>(std::move(transport), stream_limits);
+    origin.session->start();
+    co_return origin.session;
 };
 
-std::string HttpManager::postRequest(std::string url, std::string_view body, std::string content_type){
-    UrlInfo url_info = getUrlInfoByUrl(url);
+net::awaitable<std::optional<http::response_header<>>> HttpManager::performHttp2Request(
+    const http::request<http::string_body>& req, UrlInfo url_info, RequestPriority priority,
+    ChunkConsumer consumer, std::unique_ptr<HttpTransport>& http1_transport){
+    for(int attempt = 0; ; attempt++){
+        bool reused = false;
+        std::shared_ptr<Http2Session> session = co_await getHttp2Session(url_info, http1_transport, reused);
+        if(!session)
+            co_return std::nullopt;
+
+        bool delivered = false;
+        try {
+            co_return co_await session->request(req, priority, [&](std::string_view chunk){
+                delivered = true;
+                return consumer(chunk);
+            });
+        } catch(const boost::system::system_error&) {
+            // like a dead pooled connection, the server may close an idle session just as it's used
+            if(!reused || attempt > 0 || !isRetryable(req) || delivered)
+                throw;
+        }
+    }
+};
 
-    ssl::stream<tcp::socket> sock(io_ctx, ssl_ctx);
+template<class ResponseBody>
+net::awaitable<http::response<ResponseBody>> HttpManager::performRequestAsync(
+    http::request<http::string_body> req, UrlInfo url_info, RequestPriority priority){
+    std::string host_key = url_info.schem + "://" + url_info.getAuthority();
+    req.prepare_payload();
+
+    std::unique_ptr<HttpTransport> fresh_transport;
+    if(url_info.isTls() && http2_enabled){
+        std::string body;
+        std::optional<http::response_header<>> header = co_await performHttp2Request(req, url_info, priority,
+            [&body](std::string_view chunk){ body.append(chunk); return true; }, fresh_transport);
+        if(header){
+            http::response<ResponseBody> res(std::move(*header));
+            res.body() = std::move(body);
+            co_return res;
+        }
+    }
 
-    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
-    auto result = resolver.resolve(url_info.host_name, url_info.schem);
-    net::connect(sock.lowest_layer(), result);
-    sock.handshake(ssl::stream<tcp::socket>::client);
+    for(int attempt = 0; ; attempt++){
+        std::unique_ptr<PooledConnection> acquired = co_await acquireConnectionAsync(host_key);
+        ConnectionLease connection(async_connection_pool, std::move(acquired));
+        bool reused = connection->stream != nullptr;
+
+        try {
+            if(!reused && fresh_transport)
+                connection->stream = std::move(fresh_transport);
+            else if(!reused)
+                connection->stream = co_await openConnectionAsync(url_info);
+
+            co_await http::async_write(*connection->stream, req, net::use_awaitable);
+
+            beast::flat_buffer flat_buff;
+            http::response_parser<ResponseBody> parser;
+            parser.header_limit(stream_limits.max_header_bytes);
+            parser.body_limit(stream_limits.max_body_bytes);
+            co_await http::async_read(*connection->stream, flat_buff, parser, net::use_awaitable);
+
+            connection.release(parser.keep_alive());
+            co_return parser.release();
+        } catch(const boost::system::system_error&) {
+            if(!reused || attempt > 0 || !isRetryable(req))
+                throw;
+        }
+    }
+};
 
-    http::request<http::string_body> req(http::verb::post, url_info.path, 11);
-    req.set(beast::http::field::host, url_info.host_name);
-    req.set(http::field::user_agent, "MyBrowser (Linux)");
-    req.set(http::field::content_type, content_type);
-    req.body() = body;
+net::awaitable<http::response_header<>> HttpManager::performStreamingRequestAsync(
+    http::request<http::string_body> req, UrlInfo url_info, ChunkConsumer consumer, RequestPriority priority){
+    std::string host_key = url_info.schem + "://" + url_info.getAuthority();
+    req.prepare_payload();
+
+    std::unique_ptr<HttpTransport> fresh_transport;
+    if(url_info.isTls() && http2_enabled){
+        std::optional<http::response_header<>> header = co_await performHttp2Request(req, url_info, priority,
+            consumer, fresh_transport);
+        if(header)
+            co_return std::move(*header);
+    }
 
-    http::write(sock, req);
+    for(int attempt = 0; ; attempt++){
+        std::unique_ptr<PooledConnection> acquired = co_await acquireConnectionAsync(host_key);
+        ConnectionLease connection(async_connection_pool, std::move(acquired));
+        bool reused = connection->stream != nullptr;
+        bool body_started = false;
+
+        try {
+            if(!reused && fresh_transport)
+                connection->stream = std::move(fresh_transport);
+            else if(!reused)
+                connection->stream = co_await openConnectionAsync(url_info);
+
+            co_await http::async_write(*connection->stream, req, net::use_awaitable);
+
+            beast::flat_buffer flat_buff;
+            StreamedResponse streamed(stream_limits);
+            co_await http::async_read_header(*connection->stream, flat_buff, streamed.getParser(), net::use_awaitable);
+            streamed.startBody();
+            body_started = true;
+
+            bool completed = true;
+            while(!streamed.isDone()){
+                streamed.prepareWindow();
+                boost::system::error_code ec;
+                co_await http::async_read(*connection->stream, flat_buff, streamed.getParser(),
+                    net::redirect_error(net::use_awaitable, ec));
+                if(ec && ec != http::error::need_buffer)
+                    throw boost::system::system_error(ec);
+                if(!streamed.deliver(consumer)){
+                    completed = false;
+                    break;
+                }
+            }
+            if(completed)
+                streamed.finish();
+
+            connection.release(completed && streamed.getParser().keep_alive());
+            co_return streamed.getParser().get().base();
+        } catch(const boost::system::system_error&) {
+            if(!reused || attempt > 0 || !isRetryable(req) || body_started)
+                throw;
+        }
+    }
+};
 
-    beast::flat_buffer flat_buff;
-    http::response<http::string_body> res;
+template<class Result, class Executor>
+net::awaitable<Result> HttpManager::onDisk(Executor executor, std::function<Result()> work){
+    return net::async_initiate<decltype(net::use_awaitable), void(std::exception_ptr, Result)>(
+        [this, executor, work = std::move(work)](auto handler) mutable {
+            auto shared_handler = std::make_shared<decltype(handler)>(std::move(handler));
+            {
+                std::lock_guard<std::mutex> lock(disk_jobs->mut);
+                disk_jobs->pending++;
+            }
+            net::post(executor, [this, jobs = disk_jobs, work = std::move(work), shared_handler]() mutable {
+                bool accepting;
+                {
+                    std::lock_guard<std::mutex> lock(jobs->mut);
+                    accepting = jobs->accepting;
+                }
+                std::exception_ptr error;
+                Result result{};
+                if(accepting){
+                    try { result = work(); }
+                    catch(...) { error = std::current_exception(); }
+                }
+
+                // the io context is only shut down once pending is back to 0, so posting is always safe.
+                // when it's stopped the handler just waits in the queue to be destroyed with the rest
+                std::lock_guard<std::mutex> lock(jobs->mut);
+                net::post(async_io_ctx, [shared_handler, error, result = std::move(result)]() mutable {
+                    (*shared_handler)(error, std::move(result));
+                });
+                jobs->pending--;
+                jobs->idle.notify_all();
+            });
+        }, net::use_awaitable);
+};
+
+net::awaitable<http::response_header<>> HttpManager::streamLocalFileAsync(std::string path, ChunkConsumer consumer){
+    auto strea = std::make_shared<std::ifstream>();
+    size_t window_bytes = stream_limits.window_bytes;
+    std::function<std::string()> read_window = [strea, path, window_bytes](){
+        if(!strea->is_open())
+            strea->open(path, std::ios::binary);
+        std::string window(window_bytes, '\0');
+        strea->read(window.data(), window.size());
+        window.resize(std::max<std::streamsize>(strea->gcount(), 0));
+        return window;
+    };
+    for(;;){
+        std::string window = co_await onDisk(Concurrency::pool.get_executor(), read_window);
+        if(window.empty() || !consumer(window))
+            break;
+    }
 
-    http::read(sock,flat_buff, res);
-    sock.lowest_layer().close();
-    return res.body();
+    http::response_header<> res;
+    res.result(http::status::ok);
+    co_return res;
 };
-std::string HttpManager::putRequest(std::string url, std::string_view body, std::string content_type){
+
+net::awaitable<http::response_header<>> HttpManager::streamRequestCoroutine(std::string url, ChunkConsumer consumer){
+    std::function<bool()> is_local = [url]{ return fs::exists(url); };
+    if(co_await onDisk(Concurrency::pool.get_executor(), std::move(is_local)))
+        co_return co_await streamLocalFileAsync(std::move(url), std::move(consumer));
+
     UrlInfo url_info = getUrlInfoByUrl(url);
+    auto req = makeRequest(http::verb::get, url_info);
+    co_return co_await performStreamingRequestAsync(std::move(req), url_info, std::move(consumer), PriorityNormal);
+};
 
-    ssl::stream<tcp::socket> sock(io_ctx, ssl_ctx);
+net::awaitable<std::string> HttpManager::getRequestCoroutine(std::string url, RequestPriority priority){
+    std::function<std::optional<std::string>()> read_local = [url]() -> std::optional<std::string> {
+        if(!fs::exists(url))
+            return std::nullopt;
+        std::ifstream fstrea(url);
+        std::stringstream contents;
+        contents << fstrea.rdbuf();
+        return contents.str();
+    };
+    std::optional<std::string> local = co_await onDisk(Concurrency::pool.get_executor(), std::move(read_local));
+    if(local)
+        co_return std::move(*local);
 
-    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
-    auto result = resolver.resolve(url_info.host_name, url_info.schem);
-    net::connect(sock.lowest_layer(), result);
-    sock.handshake(ssl::stream<tcp::socket>::client);
+    co_return co_await fetchCachedCoroutine(std::move(url), false, priority);
+};
 
-    http::request<http::string_body> req(http::verb::put, url_info.path, 11);
-    req.set(beast::http::field::host, url_info.host_name);
-    req.set(http::field::user_agent, "MyBrowser (Linux)");
-    req.set(http::field::content_type, content_type);
-    req.body() = body;
+net::awaitable<std::string> HttpManager::getImageCoroutine(std::string url, RequestPriority priority){
+    std::function<bool()> is_local = [url]{ return fs::exists(url); };
+    if(co_await onDisk(Concurrency::pool.get_executor(), std::move(is_local)))
+        co_return url;
+
+    co_return co_await fetchCachedCoroutine(std::move(url), true, priority);
+};
 
-    http::write(sock, req);
+net::awaitable<std::string> HttpManager::fetchCachedCoroutine(std::string url, bool want_path, RequestPriority priority){
+    std::function<std::optional<CachedResponse>()> lookup = [this, url]{ return http_cache.lookup(url); };
+    std::optional<CachedResponse> cached = co_await onDisk(Concurrency::pool.get_executor(), std::move(lookup));
+    if(cached && cached->isFresh()){
+        if(want_path)
+            co_return cached->body_path;
+        std::function<std::string()> read_body = [&cached]{ return HttpCache::readBody(*cached); };
+        co_return co_await onDisk(Concurrency::pool.get_executor(), std::move(read_body));
+    }
 
-    beast::flat_buffer flat_buff;
-    http::response<http::string_body> res;
+    std::string key = getFlightKey(url, want_path);
+    if(std::shared_ptr<SingleFlight::Flight> flight = get_flights.join(key))
+        co_return co_await joinFlightAsync(std::move(flight));
 
-    http::read(sock,flat_buff, res);
-    sock.lowest_layer().close();
-    return res.body();
+    std::string result;
+    try {
+        result = co_await fetchFromOriginCoroutine(url, want_path, std::move(cached), priority);
+    } catch(...) {
+        get_flights.finish(key, std::current_exception(), "");
+        throw;
+    }
+    get_flights.finish(key, nullptr, result);
+    co_return result;
 };
-std::string HttpManager::deleteRequest(std::string url){
+
+net::awaitable<std::string> HttpManager::joinFlightAsync(std::shared_ptr<SingleFlight::Flight> flight){
+    return net::async_initiate<decltype(net::use_awaitable), void(std::exception_ptr, std::string)>(
+        [this, flight](auto handler){
+            // the leader may be a blocking call on another thread, the coroutine resumes on the io thread
+            auto shared_handler = std::make_shared<decltype(handler)>(std::move(handler));
+            get_flights.whenDone(flight, [this, shared_handler](std::exception_ptr error, std::string result){
+                net::post(async_io_ctx, [shared_handler, error, result = std::move(result)]() mutable {
+                    (*shared_handler)(error, std::move(result));
+                });
+            });
+        }, net::use_awaitable);
+};
+
+net::awaitable<std::string> HttpManager::fetchFromOriginCoroutine(std::string url, bool want_path,
+    std::optional<CachedResponse> cached, RequestPriority priority){
     UrlInfo url_info = getUrlInfoByUrl(url);
 
-    ssl::stream<tcp::socket> sock(io_ctx, ssl_ctx);
+    for(;;){
+        auto req = makeRequest(http::verb::get, url_info);
+        if(cached)
+            HttpCache::addValidators(req, *cached);
+
+        std::optional<std::string> result;
+        if(want_path){
+            // the chunks are written in order on a strand of the pool, and the store is queued behind them
+            auto disk_strand = net::make_strand(Concurrency::pool);
+            std::function<std::shared_ptr<CacheBlobWriter>()> create_writer = [this]{
+                return std::shared_ptr<CacheBlobWriter>(http_cache.createBlobWriter());
+            };
+            std::shared_ptr<CacheBlobWriter> writer = co_await onDisk(disk_strand, std::move(create_writer));
+            auto write_failed = std::make_shared<std::atomic<bool>>(false);
+            ChunkConsumer to_disk = [writer, write_failed, disk_strand](std::string_view chunk){
+                if(*write_failed)
+                    return false;
+                net::post(disk_strand, [writer, write_failed, data = std::string(chunk)](){
+                    if(!writer->write(data))
+                        *write_failed = true;
+                });
+                return true;
+            };
+            auto res = co_await performStreamingRequestAsync(std::move(req), url_info, std::move(to_disk), priority);
+            std::function<std::optional<std::string>()> complete = [&, this]{
+                return completeGet(url, res, nullptr, writer.get());
+            };
+            result = co_await onDisk(disk_strand, std::move(complete));
+        } else {
+            auto res = co_await performRequestAsync<DecodedStringBody>(std::move(req), url_info, priority);
+            std::function<std::optional<std::string>()> complete = [&, this]{
+                return completeGet(url, res.base(), &res.body(), nullptr);
+            };
+            result = co_await onDisk(Concurrency::pool.get_executor(), std::move(complete));
+        }
+
+        if(result)
+            co_return std::move(*result);
+        cached.reset();
+    }
+};
 
-    SSL_set_tlsext_host_name(sock.native_handle(), url_info.host_name.c_str());
-    auto result = resolver.resolve(url_info.host_name, url_info.schem);
-    net::connect(sock.lowest_layer(), result);
-    sock.handshake(ssl::stream<tcp::socket>::client);
+std::future<std::string> HttpManager::getRequestAsync(std::string url){
+    return net::co_spawn(async_io_ctx, getRequestCoroutine(std::move(url), PriorityNormal), net::use_future);
+};
 
-    http::request<http::string_body> req(http::verb::delete_, url_info.path, 11);
-    req.set(beast::http::field::host, url_info.host_name);
-    req.set(http::field::user_agent, "MyBrowser (Linux)");
+void HttpManager::getRequestAsync(std::string url, HttpCallback callback, RequestPriority priority){
+    net::co_spawn(async_io_ctx, getRequestCoroutine(std::move(url), priority), std::move(callback));
+};
 
-    http::write(sock, req);
+std::future<std::string> HttpManager::getImageAsync(std::string url){
+    return net::co_spawn(async_io_ctx, getImageCoroutine(std::move(url), PriorityNormal), net::use_future);
+};
 
-    beast::flat_buffer flat_buff;
-    http::response<http::string_body> res;
+void HttpManager::getImageAsync(std::string url, HttpCallback callback, RequestPriority priority){
+    net::co_spawn(async_io_ctx, getImageCoroutine(std::move(url), priority), std::move(callback));
+};
 
-    http::read(sock,flat_buff, res);
-    sock.lowest_layer().close();
-    return res.body();
+void HttpManager::streamRequestAsync(std::string url, ChunkConsumer consumer, StreamCallback callback){
+    net::co_spawn(async_io_ctx, streamRequestCoroutine(std::move(url), std::move(consumer)), std::move(callback));
 };
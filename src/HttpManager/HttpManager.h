@@ -3,10 +3,24 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/beast.hpp>
 #include <boost/asio/ssl.hpp>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <thread>
+#include "ConnectionPool.h"
+#include "ContentDecoder.h"
+#include "DnsCache.h"
+#include "HappyEyeballs.h"
+#include "Http2Session.h"
+#include "SingleFlight.h"
+#include "StreamedResponse.h"
+#include "HttpCache.h"
+#include "TlsSessionCache.h"
 #include <string>
 #include <string_view>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 using namespace std::literals::string_view_literals;
 
@@ -21,29 +35,166 @@ struct UrlInfo {
     std::string schem;
     std::string host_name;
     std::string path;
+    // empty for the scheme's default port
+    std::string port;
+
+    bool isTls() const { return schem != "http"; };
+    // what the resolver gets as the service, the port if there is one, otherwise the scheme
+    std::string getService() const { return port.empty() ? schem : port; };
+    // host[:port], for the Host header and the connection pool key
+    std::string getAuthority() const { return port.empty() ? host_name : host_name + ":" + port; };
 };
 
+// runs on the http io thread, exactly one of the two is set
+typedef std::function<void(std::exception_ptr, std::string)> HttpCallback;
+typedef std::function<void(std::exception_ptr, http::response_header<>)> StreamCallback;
+
 class HttpManager {
 public:
     net::io_context& io_ctx;
     ssl::context& ssl_ctx;
     tcp::resolver& resolver;
 
+    // every connect, sync or async, asks it before going to the resolver
+    DnsCache dns_cache;
+    // before the pool, so pooled connections are gone by the time the cache is
+    TlsSessionCache tls_session_cache;
+    ConnectionPool connection_pool;
+    // GETs from getRequest / getImage and their async versions go through it
+    HttpCache http_cache;
+    // header and body limits for every response, and the window streamed bodies are read in
+    StreamLimits stream_limits;
+    // cache misses for the same url join the GET already in flight, sync and async alike
+    SingleFlight get_flights;
+    // async https connections offer h2 through alpn, an origin that takes it gets one connection
+    // that all its requests share. blocking requests stay on http/1.1
+    bool http2_enabled = true;
+
     std::unordered_map<std::string_view, std::string_view> response_formats = {
-        {"image/png"sv, "png"sv}, {"image/jpeg"sv, "jpg"sv}, {"image/webp"sv, "webp"sv}
+        {"image/png"sv, "png"sv}, {"image/jpeg"sv, "jpg"sv}, {"image/webp"sv, "webp"sv},
+        {"image/gif"sv, "gif"sv}, {"video/mp4"sv, "mp4"sv}, {"video/webm"sv, "webm"sv}
     };
 
     HttpManager(net::io_context& io_context, ssl::context& ssl_context,
         tcp::resolver& our_resolver);
+    ~HttpManager();
 
-    // all the methods are synchronous intentionally
+    // these block the calling thread until the response is read
     std::string getRequest(std::string url);
     std::string postRequest(std::string url, std::string_view body, std::string content_type);
     std::string putRequest(std::string url, std::string_view body, std::string content_type);
     std::string deleteRequest(std::string url);
     std::string getImage(std::string url);
 
+    // these run as coroutines on one dedicated io thread, so any number can be in flight
+    // without holding a thread each. same results as their blocking versions
+    std::future<std::string> getRequestAsync(std::string url);
+    void getRequestAsync(std::string url, HttpCallback callback, RequestPriority priority = PriorityNormal);
+    std::future<std::string> getImageAsync(std::string url);
+    void getImageAsync(std::string url, HttpCallback callback, RequestPriority priority = PriorityNormal);
+
+    // a GET whose body goes to the consumer one window at a time, decoded, as it's read. the next
+    // read waits for the consumer to return, so a slow consumer throttles the download instead of
+    // buffering it. not cached, returns the status and headers
+    http::response_header<> streamRequest(std::string url, ChunkConsumer consumer);
+    // same, the consumer runs on the http io thread so it shouldn't block for long
+    void streamRequestAsync(std::string url, ChunkConsumer consumer, StreamCallback callback);
+
     UrlInfo getUrlInfoByUrl(std::string url);
+
+private:
+    // shutdown is public so the destructor can drop the suspended coroutines while
+    // everything they reference is still alive
+    class AsyncIoContext : public net::io_context {
+    public:
+        using net::io_context::shutdown;
+    };
+
+    // only ever touched from the io thread. it keeps the per host limit too, but coroutines
+    // over it wait through acquireConnectionAsync instead of blocking the thread
+    ConnectionPool async_connection_pool;
+
+    struct Http2Origin {
+        std::shared_ptr<Http2Session> session;
+        // a handshake is under way, requests arriving meanwhile wait on the timer to learn the protocol
+        bool connecting = false;
+        std::shared_ptr<net::steady_timer> connected;
+    };
+    // io thread only, like the async pool
+    std::unordered_map<std::string, Http2Origin> http2_origins;
+    // said http/1.1 to our alpn offer, their requests go straight to the pool
+    std::unordered_set<std::string> http1_origins;
+
+    // the blocking disk work of the async path ( cache lookups and stores, local files ) runs on
+    // Concurrency::pool. the destructor lets what's queued drain before it drops the coroutines
+    struct DiskJobs {
+        std::mutex mut;
+        std::condition_variable idle;
+        bool accepting = true;
+        size_t pending = 0;
+    };
+    std::shared_ptr<DiskJobs> disk_jobs = std::make_shared<DiskJobs>();
+
+    // after everything its handlers reference, so it goes first
+    AsyncIoContext async_io_ctx;
+    tcp::resolver async_resolver;
+    net::executor_work_guard<net::io_context::executor_type> async_work;
+    std::thread async_thread;
+
+    // runs work on executor ( the pool or a strand of it ), the coroutine resumes on the io thread.
+    // callers keep work in a named local, gcc 12 destroys a capturing lambda temporary inside co_await twice
+    template<class Result, class Executor>
+    net::awaitable<Result> onDisk(Executor executor, std::function<Result()> work);
+    // reads a window at a time on the pool, the consumer runs on the io thread
+    net::awaitable<http::response_header<>> streamLocalFileAsync(std::string path, ChunkConsumer consumer);
+
+    // suspends while the host is at max_per_host, resumed when a lease for it is released
+    net::awaitable<std::unique_ptr<PooledConnection>> acquireConnectionAsync(std::string host_key);
+    net::awaitable<std::unique_ptr<HttpTransport>> openConnectionAsync(UrlInfo url_info, bool offer_http2 = false);
+    // the origin's session, connecting one if needed. null if it speaks http/1.1, a connection that was
+    // opened to find that out comes back in http1_transport
+    net::awaitable<std::shared_ptr<Http2Session>> getHttp2Session(const UrlInfo& url_info,
+        std::unique_ptr<HttpTransport>& http1_transport, bool& reused);
+    // nullopt if the origin speaks http/1.1, the request hasn't been sent then
+    net::awaitable<std::optional<http::response_header<>>> performHttp2Request(const http::request<http::string_body>& req,
+        UrlInfo url_info, RequestPriority priority, ChunkConsumer consumer, std::unique_ptr<HttpTransport>& http1_transport);
+    template<class ResponseBody>
+    net::awaitable<http::response<ResponseBody>> performRequestAsync(http::request<http::string_body> req,
+        UrlInfo url_info, RequestPriority priority);
+    net::awaitable<std::string> getRequestCoroutine(std::string url, RequestPriority priority);
+    net::awaitable<std::string> getImageCoroutine(std::string url, RequestPriority priority);
+
+    // a fresh cached response never touches the network, a stale one with validators is sent
+    // conditionally. want_path gives back a file holding the body instead of the body itself
+    std::string fetchCached(const std::string& url, bool want_path);
+    net::awaitable<std::string> fetchCachedCoroutine(std::string url, bool want_path, RequestPriority priority);
+    // the network half of fetchCached, only the caller leading the flight gets here
+    std::string fetchFromOrigin(const std::string& url, bool want_path, std::optional<CachedResponse> cached);
+    net::awaitable<std::string> fetchFromOriginCoroutine(std::string url, bool want_path,
+        std::optional<CachedResponse> cached, RequestPriority priority);
+    net::awaitable<std::string> joinFlightAsync(std::shared_ptr<SingleFlight::Flight> flight);
+    static std::string getFlightKey(const std::string& url, bool want_path);
+    // nullopt when a 304 came back for an entry that got evicted meanwhile, the caller asks again.
+    // the body was either read whole ( body ) or streamed to a cache file ( writer )
+    std::optional<std::string> completeGet(const std::string& url, const http::response_header<>& res,
+        std::string* body, CacheBlobWriter* writer);
+
+    // tcp, and tls on top of it unless the url is http://
+    std::unique_ptr<HttpTransport> openConnection(const UrlInfo& url_info);
+    // writes req on a pooled connection to the host and reads the whole response,
+    // a reused connection that turns out dead is retried once on a fresh one if the method is idempotent
+    template<class ResponseBody>
+    http::response<ResponseBody> performRequest(http::request<http::string_body>& req, const UrlInfo& url_info);
+    http::response_header<> performStreamingRequest(http::request<http::string_body>& req, const UrlInfo& url_info,
+        const ChunkConsumer& consumer);
+    net::awaitable<http::response_header<>> performStreamingRequestAsync(http::request<http::string_body> req,
+        UrlInfo url_info, ChunkConsumer consumer, RequestPriority priority);
+    net::awaitable<http::response_header<>> streamRequestCoroutine(std::string url, ChunkConsumer consumer);
+    static http::response_header<> streamLocalFile(const std::string& path, const ChunkConsumer& consumer,
+        size_t window_bytes);
+    http::request<http::string_body> makeRequest(http::verb method, const UrlInfo& url_info);
+    // a server may have acted on a request it dropped the connection after, only these are safe to send twice
+    static bool isRetryable(const http::request<http::string_body>& req);
 };
 
 class HttpExposer {
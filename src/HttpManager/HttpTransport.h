@@ -0,0 +1,67 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <variant>
+
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+//
+//  One Stream Type For Both http:// And https://, Beast's Reads And Writes Go Through It Without
+//  Knowing Whether There Is A Tls Layer Underneath. It Models The Sync And Async Read / Write
+//  Stream Concepts By Forwarding To Whichever Stream It Holds
+//
+
+typedef ssl::stream<tcp::socket> SslStream;
+
+class HttpTransport {
+public:
+    typedef net::any_io_executor executor_type;
+
+    explicit HttpTransport(tcp::socket plain_socket): stream(std::move(plain_socket)) {};
+    explicit HttpTransport(SslStream tls_stream): stream(std::move(tls_stream)) {};
+
+    bool isTls() const { return std::holds_alternative<SslStream>(stream); };
+    // null for a plain connection
+    SSL* getSsl() { return isTls() ? std::get<SslStream>(stream).native_handle() : nullptr; };
+    tcp::socket& getSocket() {
+        return isTls() ? std::get<SslStream>(stream).next_layer() : std::get<tcp::socket>(stream);
+    };
+    executor_type get_executor() { return getSocket().get_executor(); };
+
+    template<class MutableBufferSequence>
+    std::size_t read_some(const MutableBufferSequence& buffers) {
+        return std::visit([&](auto& target){ return target.read_some(buffers); }, stream);
+    };
+    template<class MutableBufferSequence>
+    std::size_t read_some(const MutableBufferSequence& buffers, boost::system::error_code& ec) {
+        return std::visit([&](auto& target){ return target.read_some(buffers, ec); }, stream);
+    };
+    template<class ConstBufferSequence>
+    std::size_t write_some(const ConstBufferSequence& buffers) {
+        return std::visit([&](auto& target){ return target.write_some(buffers); }, stream);
+    };
+    template<class ConstBufferSequence>
+    std::size_t write_some(const ConstBufferSequence& buffers, boost::system::error_code& ec) {
+        return std::visit([&](auto& target){ return target.write_some(buffers, ec); }, stream);
+    };
+
+    template<class MutableBufferSequence, class ReadToken>
+    auto async_read_some(const MutableBufferSequence& buffers, ReadToken&& token) {
+        return net::async_initiate<ReadToken, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const MutableBufferSequence& target_buffers){
+                std::visit([&](auto& target){ target.async_read_some(target_buffers, std::move(handler)); }, stream);
+            }, token, buffers);
+    };
+    template<class ConstBufferSequence, class WriteToken>
+    auto async_write_some(const ConstBufferSequence& buffers, WriteToken&& token) {
+        return net::async_initiate<WriteToken, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const ConstBufferSequence& target_buffers){
+                std::visit([&](auto& target){ target.async_write_some(target_buffers, std::move(handler)); }, stream);
+            }, token, buffers);
+    };
+
+private:
+    std::variant<tcp::socket, SslStream> stream;
+};
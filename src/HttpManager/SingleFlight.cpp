@@ -0,0 +1,77 @@
+#include "SingleFlight.h"
+
+std::shared_ptr<SingleFlight::Flight> SingleFlight::join(const std::string& key) {
+    std::lock_guard<std::mutex> lock(flights_mut);
+    auto itr = flights.find(key);
+    if(itr == flights.end()){
+        flights.insert({key, std::make_shared<Flight>()});
+        return nullptr;
+    }
+
+    collapsed++;
+    return itr->second;
+};
+
+void SingleFlight::finish(const std::string& key, std::exception_ptr error, std::string result) {
+    std::vector<FlightCallback> waiters;
+    std::shared_ptr<Flight> flight;
+    {
+        std::lock_guard<std::mutex> lock(flights_mut);
+        auto itr = flights.find(key);
+        if(itr == flights.end())
+            return;
+
+        flight = std::move(itr->second);
+        flights.erase(itr);
+        flight->done = true;
+        flight->error = error;
+        flight->result = std::move(result);
+        waiters = std::move(flight->waiters);
+        flight->waiters.clear();
+    }
+    flight_done.notify_all();
+
+    // done is set, so nothing touches result anymore and it can be read without the lock
+    for(auto& waiter : waiters)
+        waiter(flight->error, flight->result);
+};
+
+void SingleFlight::failAll(std::exception_ptr error) {
+    std::vector<std::string> keys;
+    {
+        std::lock_guard<std::mutex> lock(flights_mut);
+        for(auto& [key, flight] : flights)
+            keys.push_back(key);
+    }
+    for(auto& key : keys)
+        finish(key, error, "");
+};
+
+std::string SingleFlight::wait(const std::shared_ptr<Flight>& flight) {
+    std::unique_lock<std::mutex> lock(flights_mut);
+    flight_done.wait(lock, [&]{ return flight->done; });
+    if(flight->error)
+        std::rethrow_exception(flight->error);
+    return flight->result;
+};
+
+void SingleFlight::whenDone(const std::shared_ptr<Flight>& flight, FlightCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(flights_mut);
+        if(!flight->done){
+            flight->waiters.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(flight->error, flight->result);
+};
+
+size_t SingleFlight::getCollapsed() {
+    std::lock_guard<std::mutex> lock(flights_mut);
+    return collapsed;
+};
+
+size_t SingleFlight::getInFlight() {
+    std::lock_guard<std::mutex> lock(flights_mut);
+    return flights.size();
+};
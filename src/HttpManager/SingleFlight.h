@@ -0,0 +1,50 @@
+#pragma once
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+//  Collapses Identical Requests That Are In Flight At The Same Time Into One. The First Caller
+//  For A Key Leads And Does The Work, Everyone Who Asks For The Same Key Before It Finishes
+//  Joins It And Gets The Same Result ( Or The Same Exception ) Instead Of Going Out Again
+//
+
+typedef std::function<void(std::exception_ptr, std::string)> FlightCallback;
+
+class SingleFlight {
+public:
+    struct Flight {
+        bool done = false;
+        std::exception_ptr error;
+        std::string result;
+        std::vector<FlightCallback> waiters;
+    };
+
+    // nullptr when the caller leads, it does the request and has to call finish with the outcome.
+    // otherwise the flight to wait on, the request is already on its way
+    std::shared_ptr<Flight> join(const std::string& key);
+    // hands the outcome to everyone who joined, the next join for the key starts a new flight
+    void finish(const std::string& key, std::exception_ptr error, std::string result);
+    // finishes every open flight with error, for leaders that will never get to it ( shutdown )
+    void failAll(std::exception_ptr error);
+
+    // blocks until the flight is done, throws what the leader threw
+    std::string wait(const std::shared_ptr<Flight>& flight);
+    // runs right away if the flight is already done, otherwise on the leader's thread when it is
+    void whenDone(const std::shared_ptr<Flight>& flight, FlightCallback callback);
+
+    // requests that joined a flight instead of being sent
+    size_t getCollapsed();
+    size_t getInFlight();
+
+private:
+    std::mutex flights_mut;
+    std::condition_variable flight_done;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+    size_t collapsed = 0;
+};
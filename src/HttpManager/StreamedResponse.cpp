@@ -0,0 +1,32 @@
+#include "StreamedResponse.h"
+
+StreamedResponse::StreamedResponse(const StreamLimits& limits): window(limits.window_bytes) {
+    parser.header_limit(limits.max_header_bytes);
+    parser.body_limit(limits.max_body_bytes);
+};
+
+void StreamedResponse::startBody() {
+    auto content_encoding = parser.get()[http::field::content_encoding];
+    decoder.emplace(ContentDecoder::getEncoding(std::string_view(content_encoding.data(), content_encoding.size())));
+};
+
+void StreamedResponse::prepareWindow() {
+    parser.get().body().data = window.data();
+    parser.get().body().size = window.size();
+};
+
+bool StreamedResponse::deliver(const ChunkConsumer& consumer) {
+    size_t read_size = window.size() - parser.get().body().size;
+    if(read_size == 0)
+        return true;
+
+    decoded.clear();
+    if(!decoder->decode(std::string_view(window.data(), read_size), decoded))
+        throw boost::system::system_error(boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence));
+    return decoded.empty() || consumer(decoded);
+};
+
+void StreamedResponse::finish() {
+    if(!decoder->finish())
+        throw boost::system::system_error(boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence));
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "ContentDecoder.h"
+#include <boost/beast/http.hpp>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http = boost::beast::http;
+
+//
+//  Reads A Response Body A Fixed Window At A Time And Hands Each Decoded Piece To A Consumer
+//  Before Reading The Next One, So A Download Never Holds More Than One Window In Memory And A
+//  Slow Consumer Slows The Socket Down Instead Of Letting The Body Pile Up
+//
+
+struct StreamLimits {
+    size_t max_header_bytes = 16 * 1024;
+    // counted on the wire, before decoding
+    size_t max_body_bytes = 512 * 1024 * 1024;
+    size_t window_bytes = 64 * 1024;
+};
+
+// gets each decoded chunk in order, returning false drops the rest of the response
+typedef std::function<bool(std::string_view chunk)> ChunkConsumer;
+
+// the caller drives the reads, so the same window handling works with blocking and coroutine io
+class StreamedResponse {
+public:
+    explicit StreamedResponse(const StreamLimits& limits);
+
+    http::response_parser<http::buffer_body>& getParser() { return parser; };
+    bool isDone() { return parser.is_done(); };
+
+    // once the header is in, picks the decoder for its Content-Encoding
+    void startBody();
+    // before every body read, points the parser at the empty window
+    void prepareWindow();
+    // decodes what the last read left in the window and passes it on, false if the consumer stopped
+    bool deliver(const ChunkConsumer& consumer);
+    // throws if the encoded stream ended early
+    void finish();
+
+private:
+    http::response_parser<http::buffer_body> parser;
+    std::vector<char> window;
+    std::optional<ContentDecoder> decoder;
+    std::string decoded;
+};
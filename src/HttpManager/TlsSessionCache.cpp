@@ -0,0 +1,111 @@
+#include "TlsSessionCache.h"
+
+TlsSessionCache::TlsSessionCache(std::chrono::seconds session_lifetime, size_t max_hosts):
+    lifetime(session_lifetime), max_cached_hosts(max_hosts) {
+};
+
+TlsSessionCache::~TlsSessionCache() {
+    clear();
+};
+
+int TlsSessionCache::getExIndex() {
+    static int ex_index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return ex_index;
+};
+
+void TlsSessionCache::attach(ssl::context& ssl_ctx) {
+    SSL_CTX* native_ctx = ssl_ctx.native_handle();
+    // openssl's own store is keyed for servers, we keep ours per host
+    SSL_CTX_set_session_cache_mode(native_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_set_ex_data(native_ctx, getExIndex(), this);
+    SSL_CTX_sess_set_new_cb(native_ctx, &TlsSessionCache::onNewSession);
+};
+
+int TlsSessionCache::onNewSession(SSL* ssl, SSL_SESSION* session) {
+    auto* cache = static_cast<TlsSessionCache*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), getExIndex()));
+    const char* host_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if(cache == nullptr || host_name == nullptr)
+        return 0;
+
+    cache->storeSession(host_name, session);
+    // 1 = we keep the reference openssl handed us
+    return 1;
+};
+
+void TlsSessionCache::storeSession(const std::string& host_name, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+
+    auto itr = sessions.find(host_name);
+    if(itr != sessions.end()){
+        SSL_SESSION_free(itr->second.session);
+        sessions.erase(itr);
+    } else if(sessions.size() >= max_cached_hosts){
+        evictOldest();
+    }
+    sessions.insert({host_name, {session, std::chrono::steady_clock::now()}});
+};
+
+void TlsSessionCache::offerSession(SSL* ssl, const std::string& host_name) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+
+    auto itr = sessions.find(host_name);
+    if(itr == sessions.end())
+        return;
+
+    if(std::chrono::steady_clock::now() - itr->second.stored_at >= lifetime ||
+        !SSL_SESSION_is_resumable(itr->second.session)){
+        SSL_SESSION_free(itr->second.session);
+        sessions.erase(itr);
+        return;
+    }
+
+    // takes its own reference, the cached one stays valid for other connections
+    SSL_set_session(ssl, itr->second.session);
+};
+
+void TlsSessionCache::recordHandshake(SSL* ssl) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    if(SSL_session_reused(ssl))
+        hits++;
+    else
+        misses++;
+};
+
+void TlsSessionCache::evictOldest() {
+    auto oldest = sessions.begin();
+    for(auto itr = sessions.begin(); itr != sessions.end(); itr++)
+        if(itr->second.stored_at < oldest->second.stored_at)
+            oldest = itr;
+
+    if(oldest == sessions.end())
+        return;
+    SSL_SESSION_free(oldest->second.session);
+    sessions.erase(oldest);
+};
+
+void TlsSessionCache::setLifetime(std::chrono::seconds session_lifetime) {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    lifetime = session_lifetime;
+};
+
+void TlsSessionCache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    for(auto& [host_name, cached] : sessions)
+        SSL_SESSION_free(cached.session);
+    sessions.clear();
+};
+
+size_t TlsSessionCache::getHits() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return hits;
+};
+
+size_t TlsSessionCache::getMisses() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return misses;
+};
+
+size_t TlsSessionCache::size() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return sessions.size();
+};
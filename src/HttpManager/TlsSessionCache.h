@@ -0,0 +1,56 @@
+#pragma once
+#include <boost/asio/ssl.hpp>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <openssl/ssl.h>
+
+namespace ssl = boost::asio::ssl;
+
+//
+//  Remembers The Last Tls Session ( Session Id Or Ticket ) Each Host Gave Us And Offers It
+//  On The Next Cold Connect, So The Server Can Answer With An Abbreviated Handshake
+//  Instead Of Redoing The Key Exchange And Sending Its Certificate Chain Again
+//
+
+class TlsSessionCache {
+public:
+    explicit TlsSessionCache(std::chrono::seconds session_lifetime = std::chrono::hours(2),
+        size_t max_hosts = 256);
+    ~TlsSessionCache();
+
+    // turns on client side caching for the context and routes its new sessions here,
+    // tls 1.3 tickets only show up after the handshake so a callback is the only reliable way
+    void attach(ssl::context& ssl_ctx);
+
+    // before the handshake, the host is also what we send as sni
+    void offerSession(SSL* ssl, const std::string& host_name);
+    // after the handshake, counts whether the offered session was accepted
+    void recordHandshake(SSL* ssl);
+
+    void setLifetime(std::chrono::seconds session_lifetime);
+    void clear();
+
+    size_t getHits();
+    size_t getMisses();
+    size_t size();
+
+private:
+    struct CachedSession {
+        SSL_SESSION* session;
+        std::chrono::steady_clock::time_point stored_at;
+    };
+
+    std::mutex cache_mut;
+    std::unordered_map<std::string, CachedSession> sessions;
+    std::chrono::seconds lifetime;
+    size_t max_cached_hosts;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    static int getExIndex();
+    static int onNewSession(SSL* ssl, SSL_SESSION* session);
+    void storeSession(const std::string& host_name, SSL_SESSION* session);
+    void evictOldest();
+};
@@ -0,0 +1,113 @@
+#include "DecodedImageCache.h"
+
+DecodedImageCache DecodedImageCache::shared;
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes): max_cached_bytes(max_bytes) {
+};
+
+std::string DecodedImageCache::getKey(const std::string& url, int width, int height) {
+    return std::to_string(width) + "x" + std::to_string(height) + " " + url;
+};
+
+void DecodedImageCache::get(const std::string& url, int width, int height, ImageLoader load,
+    DecodeCallback callback) {
+    std::string key = getKey(url, width, height);
+    Glib::RefPtr<Gdk::Texture> texture;
+    {
+        std::lock_guard<std::mutex> lock(cache_mut);
+        auto itr = images.find(key);
+        if(itr != images.end()){
+            hits++;
+            bytes_saved += itr->second.fetched_bytes;
+            lru.splice(lru.begin(), lru, itr->second.lru_itr);
+            texture = itr->second.texture;
+        } else {
+            auto [waiting, first] = in_flight.try_emplace(key);
+            waiting->second.push_back(std::move(callback));
+            if(!first){
+                coalesced++;
+                return;
+            }
+            misses++;
+        }
+    }
+
+    if(texture){
+        callback(std::move(texture));
+        return;
+    }
+    load([this, key](Glib::RefPtr<Gdk::Texture> loaded, size_t fetched_bytes){
+        onLoaded(key, std::move(loaded), fetched_bytes);
+    });
+};
+
+void DecodedImageCache::onLoaded(const std::string& key, Glib::RefPtr<Gdk::Texture> texture,
+    size_t fetched_bytes) {
+    std::vector<DecodeCallback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(cache_mut);
+        waiters = std::move(in_flight[key]);
+        in_flight.erase(key);
+        bytes_saved += fetched_bytes * (waiters.size() - 1);
+
+        // a failed load isn't remembered, the next <img> gets to try again
+        if(texture && !images.contains(key)){
+            size_t texture_bytes = (size_t)texture->get_width() * texture->get_height() * 4;
+            lru.push_front(key);
+            images.insert({key, {texture, texture_bytes, fetched_bytes, lru.begin()}});
+            total_bytes += texture_bytes;
+            evictToBudget();
+        }
+    }
+
+    for(auto& waiter : waiters)
+        waiter(texture);
+};
+
+void DecodedImageCache::evictToBudget() {
+    // the texture itself lives on in any widget still showing it, only our reference goes
+    while(total_bytes > max_cached_bytes && lru.size() > 1){
+        auto itr = images.find(lru.back());
+        total_bytes -= itr->second.texture_bytes;
+        images.erase(itr);
+        lru.pop_back();
+    }
+};
+
+void DecodedImageCache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    images.clear();
+    lru.clear();
+    total_bytes = 0;
+};
+
+size_t DecodedImageCache::getHits() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return hits;
+};
+
+size_t DecodedImageCache::getMisses() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return misses;
+};
+
+size_t DecodedImageCache::getCoalesced() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return coalesced;
+};
+
+size_t DecodedImageCache::getBytesSaved() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return bytes_saved;
+};
+
+double DecodedImageCache::getHitRate() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    size_t requests = hits + misses + coalesced;
+    return requests == 0 ? 0.0 : (double)(hits + coalesced) / requests;
+};
+
+size_t DecodedImageCache::sizeInBytes() {
+    std::lock_guard<std::mutex> lock(cache_mut);
+    return total_bytes;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "ImageDecoder.h"
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+//  Process Wide Cache Of Decoded Textures Keyed By Url And Decode Size. Every <img> With The Same
+//  src And Size Shares One Texture, And While The First One Is Still Loading The Rest Just Wait
+//  For It Instead Of Downloading And Decoding It Again
+//
+
+// the texture ( empty on failure ) and how many encoded bytes had to be fetched for it
+typedef std::function<void(Glib::RefPtr<Gdk::Texture>, size_t)> ImageLoadDone;
+// starts fetching and decoding one image, must call done exactly once from any thread
+typedef std::function<void(ImageLoadDone)> ImageLoader;
+
+class DecodedImageCache {
+public:
+    static DecodedImageCache shared;
+
+    explicit DecodedImageCache(size_t max_bytes = 128 * 1024 * 1024);
+
+    // a cached texture goes to the callback right away, otherwise it runs on whatever thread
+    // the load finishes on. load is only called for the first request of a key
+    void get(const std::string& url, int width, int height, ImageLoader load, DecodeCallback callback);
+
+    void clear();
+
+    size_t getHits();
+    size_t getMisses();
+    // requests that joined a load already in flight
+    size_t getCoalesced();
+    // encoded bytes hits and coalesced requests didn't have to fetch again
+    size_t getBytesSaved();
+    double getHitRate();
+    size_t sizeInBytes();
+
+private:
+    struct CachedImage {
+        Glib::RefPtr<Gdk::Texture> texture;
+        size_t texture_bytes;
+        size_t fetched_bytes;
+        std::list<std::string>::iterator lru_itr;
+    };
+
+    std::mutex cache_mut;
+    std::unordered_map<std::string, CachedImage> images;
+    std::unordered_map<std::string, std::vector<DecodeCallback>> in_flight;
+    // most recently used at the front
+    std::list<std::string> lru;
+    size_t max_cached_bytes;
+    size_t total_bytes = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t coalesced = 0;
+    size_t bytes_saved = 0;
+
+    static std::string getKey(const std::string& url, int width, int height);
+    void onLoaded(const std::string& key, Glib::RefPtr<Gdk::Texture> texture, size_t fetched_bytes);
+    // expects cache_mut to be held
+    void evictToBudget();
+};
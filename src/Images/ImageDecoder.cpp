@@ -0,0 +1,74 @@
+#include "ImageDecoder.h"
+#include "../Concurrency/ThreadPool.h"
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <fstream>
+#include <gdkmm/pixbufloader.h>
+#include <iostream>
+#include <sstream>
+
+Glib::RefPtr<Gdk::Texture> ImageDecoder::decode(std::string_view bytes, int width, int height) {
+    try {
+        auto loader = Gdk::PixbufLoader::create();
+        // fires once the header is parsed, before any pixels are decoded, so a large image
+        // is decoded straight into the small buffer instead of being scaled afterwards
+        loader->signal_size_prepared().connect([&loader, width, height](int natural_width, int natural_height){
+            int decode_width, decode_height;
+            getDecodeSize(natural_width, natural_height, width, height, decode_width, decode_height);
+            if(decode_width != natural_width || decode_height != natural_height)
+                loader->set_size(decode_width, decode_height);
+        });
+
+        loader->write(reinterpret_cast<const guint8*>(bytes.data()), bytes.size());
+        loader->close();
+
+        Glib::RefPtr<Gdk::Pixbuf> pixbuf = loader->get_pixbuf();
+        if(!pixbuf)
+            return {};
+        return Gdk::Texture::create_for_pixbuf(pixbuf);
+    } catch(const Glib::Error& error) {
+        std::cout << "couldn't decode image: " << error.what() << std::endl;
+        return {};
+    }
+};
+
+void ImageDecoder::decodeAsync(std::string bytes, int width, int height, DecodeCallback callback) {
+    boost::asio::post(Concurrency::pool, [bytes = std::move(bytes), width, height, callback = std::move(callback)](){
+        callback(decode(bytes, width, height));
+    });
+};
+
+void ImageDecoder::decodeFileAsync(std::string path, int width, int height, DecodeCallback callback) {
+    boost::asio::post(Concurrency::pool, [path = std::move(path), width, height, callback = std::move(callback)](){
+        std::ifstream strea(path, std::ios::binary);
+        std::stringstream contents;
+        contents << strea.rdbuf();
+        callback(decode(contents.str(), width, height));
+    });
+};
+
+void ImageDecoder::getDecodeSize(int natural_width, int natural_height, int width, int height,
+    int& decode_width, int& decode_height) {
+    decode_width = natural_width;
+    decode_height = natural_height;
+    if(natural_width <= 0 || natural_height <= 0)
+        return;
+
+    double scale = 1.0;
+    if(width > 0 && height > 0){
+        // both given, the image gets stretched to exactly that
+        decode_width = std::min(width, natural_width);
+        decode_height = std::min(height, natural_height);
+        return;
+    } else if(width > 0)
+        scale = (double)width / natural_width;
+    else if(height > 0)
+        scale = (double)height / natural_height;
+    else
+        scale = (double)max_decode_dimension / std::max(natural_width, natural_height);
+
+    if(scale >= 1.0)
+        return;
+    decode_width = std::max(1, (int)(natural_width * scale));
+    decode_height = std::max(1, (int)(natural_height * scale));
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <functional>
+#include <gdkmm/texture.h>
+#include <glibmm/refptr.h>
+#include <string>
+#include <string_view>
+
+//
+//  Decodes Image Bytes Straight From Memory On The Worker Pool, Scaled Down To The Size They
+//  Will Be Shown At, So Neither A Temp File Nor A Full Resolution Decode Ever Reaches The Gtk Thread
+//
+
+typedef std::function<void(Glib::RefPtr<Gdk::Texture>)> DecodeCallback;
+
+class ImageDecoder {
+public:
+    // without a width / height attribute nothing bigger than this is kept around
+    static constexpr int max_decode_dimension = 2048;
+
+    // on the calling thread, an empty RefPtr if the bytes aren't an image gdk-pixbuf knows.
+    // width / height are the requested display size, 0 for "whatever the image is"
+    static Glib::RefPtr<Gdk::Texture> decode(std::string_view bytes, int width = 0, int height = 0);
+    // on Concurrency::pool, the callback runs there too
+    static void decodeAsync(std::string bytes, int width, int height, DecodeCallback callback);
+    static void decodeFileAsync(std::string path, int width, int height, DecodeCallback callback);
+
+    // never upscales, a missing side keeps the aspect ratio
+    static void getDecodeSize(int natural_width, int natural_height, int width, int height,
+        int& decode_width, int& decode_height);
+};
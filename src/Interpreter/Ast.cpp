@@ -1,7 +1,17 @@
 #include "Ast.h"
+#include "StyleManagement/InlineStyleRegistry.h"
 
 void HTMLTag::render(Gtk::Box* box){
     renderer->render(this, box);
+    if(!tag_information.current_widget)
+        return;
+    for(auto& binding : event_bindings)
+        binding.event->bindEventToWidget(tag_information.current_widget, binding.executor);
+}
+void HTMLTag::addEvent(std::unique_ptr<Event> event, SigmaInterpreter* executor){
+    if(tag_information.current_widget)
+        event->bindEventToWidget(tag_information.current_widget, executor);
+    event_bindings.push_back({std::move(event), executor});
 }
 void HTMLTag::unRender(){
     renderer->unRender(this);
@@ -19,16 +29,27 @@ void HTMLTag::setChildren(std::vector<std::shared_ptr<HTMLTag>> tags){
 };
 
 std::vector<std::string> HTMLTag::getClassNames(){
-    if(props.contains("class")){
-        std::istringstream stream(props["class"]);
-        std::vector<std::string> class_names;
-        std::string current;
+    auto class_itr = props.find("class");
+    if(class_itr == props.end())
+        return {};
+    return HTMLTagCssManager::getCssClasses(class_itr->second);
+};
 
-         while((stream >> current))
-            class_names.push_back(current);
-        
-        return class_names;
-    } else return {};
+const StyleInputs& HTMLTag::getStyleInputs(){
+    if(!style_inputs_ready)
+        precomputeStyleInputs();
+    return style_inputs;
+};
+
+void HTMLTag::precomputeStyleInputs(){
+    style_inputs.css_classes = getClassNames();
+    style_inputs.inline_style_class.clear();
+
+    auto style_itr = props.find("style");
+    if(style_itr != props.end())
+        style_inputs.inline_style_class = InlineStyleRegistry::getClassForStyle(style_itr->second);
+
+    style_inputs_ready = true;
 };
 
 
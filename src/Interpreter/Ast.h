@@ -2,16 +2,20 @@
 #include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <filesystem>
+#include <gdkmm/texture.h>
 #include <glibmm/refptr.h>
 #include <gtk/gtk.h>
 #include <gtkmm/cssprovider.h>
 #include <gtkmm/entry.h>
 #include <gtkmm/enums.h>
 #include <gtkmm/image.h>
+#include <gtkmm/listview.h>
 #include <gtkmm/object.h>
+#include <gtkmm/stringlist.h>
 #include <gtkmm/video.h>
 #include <gtkmm/widget.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -22,8 +26,10 @@
 #include <uuid/uuid.h>
 #include <glibmm/dispatcher.h>
 #include "TagRendering/TagRenderers.h"
+#include "../SigmaInterpreter/EventHandling/EventHandling.h"
 
 class LambdaVal;
+struct ComputedStyleRecord;
 
 enum TagType {
     Html, Body, Head, h1, h2, h3, h4, h5, p, String, Image, Input, Button, Div, Stylee, Scriptt,
@@ -39,8 +45,21 @@ struct TagInformation {
     Gtk::Box* parent_widget = nullptr;
 };
 
+// resolved once from props ( usually on a worker thread while the page is prepared )
+struct StyleInputs {
+    std::vector<std::string> css_classes;
+    // generated by the InlineStyleRegistry, empty if there's no style prop
+    std::string inline_style_class;
+};
+
 class HTMLTag;
 
+// a script handler lives on the tag, not on its widget, so a re-render ( a recycled virtualized row ) gets it back
+struct TagEventBinding {
+    std::unique_ptr<Event> event;
+    SigmaInterpreter* executor;
+};
+
 typedef std::unordered_map<std::string, std::string> Properties;
 typedef std::vector<std::shared_ptr<HTMLTag>> Children;
 typedef std::unique_ptr<HTMLTagRenderer> HTMLTagRendererPtr;
@@ -54,7 +73,15 @@ public:
 
     std::unique_ptr<HTMLTagRenderer> renderer;
 
-    Glib::RefPtr<Gtk::CssProvider> css_provider;
+    StyleInputs style_inputs;
+    bool style_inputs_ready = false;
+
+    // generated from the matched <style> rules by the StyleResolver, and the widget it was put on
+    std::shared_ptr<const ComputedStyleRecord> style_record;
+    std::string sheet_style_class;
+    Gtk::Widget* sheet_styled_widget = nullptr;
+
+    std::vector<TagEventBinding> event_bindings;
 
     HTMLTag(TagType t, std::string html_element_name, std::string element_name):
         tag_information({t, "", html_element_name,
@@ -76,11 +103,17 @@ public:
     };
 
     void render(Gtk::Box* box);
+    // binds right away when the tag has a widget, and again on every later render
+    void addEvent(std::unique_ptr<Event> event, SigmaInterpreter* executor);
 
     void flatten(std::vector<std::shared_ptr<HTMLTag>>& tags);
     void setChildren(std::vector<std::shared_ptr<HTMLTag>> tags);
     std::vector<std::string> getClassNames();
 
+    const StyleInputs& getStyleInputs();
+    void precomputeStyleInputs();
+    void invalidateStyleInputs() { style_inputs_ready = false; };
+
     void setInnerHtml(std::vector<std::shared_ptr<HTMLTag>> tags) {
         children = tags;
     };
@@ -121,6 +154,12 @@ public:
         std::make_unique<ContainerTagRenderer>()) {};
     Gtk::Box* container_box = nullptr;
 
+    // only used when the container is rendered virtualized
+    Gtk::ListView* list_view = nullptr;
+    Glib::RefPtr<Gtk::StringList> virtual_rows;
+    // weak, a child removed by a script can be freed while its row is still bound
+    std::unordered_map<Gtk::Widget*, std::weak_ptr<HTMLTag>> materialized_rows;
+
     std::shared_ptr<HTMLTag> cloneSelf();
     void cloneHirarichy(std::vector<std::shared_ptr<HTMLTag>>& result_tags);
     
@@ -195,7 +234,7 @@ public:
         HTMLTag(String, "String", "label",
             std::make_unique<StringTagRenderer>()),
             str(stringg), parent_class_name(p_class_name) {};
-    Gtk::Label* lab;
+    Gtk::Label* lab = nullptr;
 
     std::string unTokenizeHirarichy() override;
 
@@ -210,7 +249,8 @@ public:
     TextTag(TagType type, std::string html_element_name,
         std::string element_name): HTMLTag(type, html_element_name, element_name,
             std::make_unique<TextTagRenderer>()) {};
-    Gtk::Box* box;
+    Gtk::Box* box = nullptr;
+    bool props_propagated = false;
 
     std::shared_ptr<HTMLTag> cloneSelf();
     void cloneHirarichy(std::vector<std::shared_ptr<HTMLTag>>& result_tags);
@@ -248,19 +288,31 @@ public:
     PTag(): HTMLTag(p, "p", "label") {};
 };
 
+// where another thread leaves what a media tag loaded ( an image's decoded texture, a video's
+// downloaded file ), shared with it so a load that finishes after the tag is gone has somewhere to go
+struct MediaHandoff {
+    std::mutex mut;
+    Glib::RefPtr<Gdk::Texture> texture;
+    std::string path;
+    // the tag's dispatcher, null once the tag is destroyed
+    Glib::Dispatcher* disp = nullptr;
+
+    // call with mut held
+    void notify() { if(disp) disp->emit(); };
+    void detach() { std::lock_guard<std::mutex> lock(mut); disp = nullptr; };
+};
+
 class ImageTag : public HTMLTag {
 public:
     ImageTag(): HTMLTag(Image, "img", "image",
         std::make_unique<ImageTagRenderer>()) {};
-    Gtk::Image* image;
-    std::string img_path;
-    Glib::Dispatcher disp;
-
-    ~ImageTag() {
-        if(std::filesystem::exists(img_path)){
-            std::filesystem::remove(img_path);
-        }
-    }
+    ~ImageTag() { handoff->detach(); };
+    Gtk::Image* image = nullptr;
+    // decoded on the pool at display size, the dispatcher only hands it to the widget
+    std::shared_ptr<MediaHandoff> handoff = std::make_shared<MediaHandoff>();
+    // created on the first render, a dispatcher has to be constructed on the receiving ( gtk )
+    // thread and tags may be parsed on a worker thread
+    std::unique_ptr<Glib::Dispatcher> disp;
 
     std::shared_ptr<HTMLTag> cloneSelf();
     void cloneHirarichy(std::vector<std::shared_ptr<HTMLTag>>& result_tags);
@@ -270,7 +322,9 @@ class InputTag : public HTMLTag {
 public:
     InputTag(): HTMLTag(Input, "input", "input",
         std::make_unique<InputTagRenderer>()){};
-    Gtk::Entry* input;
+    Gtk::Entry* input = nullptr;
+    // kept in sync with the entry, it's what a script reads while the input isn't rendered
+    std::string text;
 
     std::shared_ptr<HTMLTag> cloneSelf();
     void cloneHirarichy(std::vector<std::shared_ptr<HTMLTag>>& result_tags);
@@ -282,7 +336,7 @@ class ButtonTag : public HTMLTag {
 public:
     ButtonTag(): HTMLTag(Button, "button", "button", 
         std::make_unique<ButtonTagRenderer>()) {};
-    Gtk::Button* button;
+    Gtk::Button* button = nullptr;
     std::string str;
     
     std::shared_ptr<HTMLTag> cloneSelf();
@@ -306,7 +360,11 @@ public:
 class VideoTag : public HTMLTag {
 public:
     std::string src;
-    Gtk::Video* vid;
+    Gtk::Video* vid = nullptr;
+    // the path of a preloaded remote video once it's on disk
+    std::shared_ptr<MediaHandoff> handoff = std::make_shared<MediaHandoff>();
+    std::unique_ptr<Glib::Dispatcher> disp;
     VideoTag(): HTMLTag(Video, "video", "video", 
         std::make_unique<VideoTagRenderer>()) {};
+    ~VideoTag() { handoff->detach(); };
 };
\ No newline at end of file
@@ -24,6 +24,10 @@
 #include "../SigmaInterpreter/Util/Permissions/Permissions.h"
 #include "../SigmaInterpreter/PreProcessor/PreProcessor.h"
 #include "../SigmaInterpreter/StandardLibrary/WindowLib/WindowLib.h"
+#include "StyleManagement/InlineStyleRegistry.h"
+#include "../StyleSheets/StyleResolver.h"
+#include "PreloadScanner.h"
+#include <sstream>
 
 namespace fs = std::filesystem;
 
@@ -35,6 +39,23 @@ struct DOMAccessor {
     Interpreter* current_interp;
 };
 
+// Everything That Doesn't Touch Gtk, Can Be Built On A Worker Thread
+// And Handed Over To renderPreparedDocument On The Main Loop
+struct PreparedDocument {
+    Program program;
+    std::vector<std::shared_ptr<HTMLTag>> flattened_tags;
+    std::unordered_multimap<std::string, std::shared_ptr<HTMLTag>> class_name_ptrs;
+    std::unordered_map<std::string, std::shared_ptr<HTMLTag>> id_ptrs;
+    std::string document_or_host;
+    // null when the page came from a Program ( innerHtml ) or there's no internet
+    std::shared_ptr<PreloadScheduler> preloads;
+    // generated style classes from before this are dropped once it's rendered, 0 keeps them all
+    uint64_t style_generation = 0;
+    // <style> and <script> sources, loaded while preparing so rendering never waits on them,
+    // a tag that isn't in here failed to load
+    std::unordered_map<HTMLTag*, std::string> subresources;
+};
+
 class Interpreter {
 public:
     SigmaLexer scripting_lexer;
@@ -45,11 +66,140 @@ public:
     Parser parser;
 
     std::vector<Glib::RefPtr<Gtk::CssProvider>> css_providers;
+    // rules from <style> tags that the selector engine matches itself
+    StyleRuleSet style_rules;
+    ComputedStyleCache style_cache;
     std::vector<std::shared_ptr<HTMLTag>> current_tags;
 
     DOMAccessor accessor;
 
+    static void indexIdsAndClasses(std::vector<std::shared_ptr<HTMLTag>>& flattened_tags,
+        std::unordered_multimap<std::string, std::shared_ptr<HTMLTag>>& class_name_ptrs,
+        std::unordered_map<std::string, std::shared_ptr<HTMLTag>>& id_ptrs) {
+        for(auto& tag : flattened_tags){
+            if(tag->props.contains("id"))
+                id_ptrs.insert({tag->props["id"], tag});
+            if (tag->props.contains("class"))
+                for(auto& cl : tag->getStyleInputs().css_classes)
+                    class_name_ptrs.insert({cl, tag});
+        }
+    }
+
+    // thread safe, uses its own lexer and parser
+    static PreparedDocument prepareDocument(std::string html_text, std::string document_or_host) {
+        // only a navigation starts a style generation, innerHtml renders belong to the page they're in
+        uint64_t style_generation = InlineStyleRegistry::beginGeneration();
+        Lexer local_lexer;
+        Parser local_parser;
+        auto tokens = local_lexer.tokenize(html_text);
+
+        // subresources start downloading before the parser even runs
+        std::shared_ptr<PreloadScheduler> preloads;
+        if(HttpExposer::current_http_manager){
+            preloads = std::make_shared<PreloadScheduler>(HttpExposer::current_http_manager);
+            preloads->enqueue(PreloadScanner::scan(tokens, document_or_host));
+        }
+
+        PreparedDocument prepared = prepareDocument(local_parser.produceAst(tokens), std::move(document_or_host),
+            std::move(preloads));
+        prepared.style_generation = style_generation;
+        return prepared;
+    }
+
+    // runs on the preparing thread, remote sources come from the preload scanner when it saw them,
+    // local ones from disk
+    static bool loadSubresource(const std::string& src, const std::shared_ptr<PreloadScheduler>& preloads,
+        std::string& code) {
+        try{
+            if(preloads && preloads->contains(src)){
+                code = preloads->wait(src);
+                return true;
+            }
+            if(PreloadScanner::isRemote(src) && HttpExposer::current_http_manager){
+                code = HttpExposer::current_http_manager->getRequest(src);
+                return true;
+            }
+        } catch(std::exception& exception) {
+            std::cout << "Failed To Load " << src << " : " << exception.what() << std::endl;
+            return false;
+        }
+
+        if(!fs::exists(src))
+            return false;
+        std::ifstream file_stream(src);
+        std::stringstream contents;
+        contents << file_stream.rdbuf();
+        code = contents.str();
+        return true;
+    }
+
+    static PreparedDocument prepareDocument(Program tags, std::string document_or_host,
+        std::shared_ptr<PreloadScheduler> preloads = nullptr) {
+        PreparedDocument prepared;
+        prepared.document_or_host = std::move(document_or_host);
+        prepared.preloads = std::move(preloads);
+
+        for(auto& tag : tags.html_tags){
+            tag->flatten(prepared.flattened_tags);
+        }
+        // flatten is pre order, so parents push their props down before the children resolve theirs
+        for(auto& tag : prepared.flattened_tags){
+            tag->renderer->css_manager->propagateProps(tag.get());
+            tag->precomputeStyleInputs();
+        }
+        indexIdsAndClasses(prepared.flattened_tags, prepared.class_name_ptrs, prepared.id_ptrs);
+        loadSubresources(prepared);
+
+        prepared.program = std::move(tags);
+        return prepared;
+    }
+
+    static void loadSubresources(PreparedDocument& prepared) {
+        for(auto& tag : prepared.flattened_tags){
+            std::string* src = nullptr;
+            if(tag->tag_information.type == Stylee)
+                src = &std::static_pointer_cast<StyleTag>(tag)->src;
+            else if(tag->tag_information.type == Scriptt)
+                src = &std::static_pointer_cast<ScriptTag>(tag)->src;
+            else continue;
+
+            *src = PreloadScanner::resolveUrl(prepared.document_or_host, *src);
+            std::string code;
+            if(loadSubresource(*src, prepared.preloads, code))
+                prepared.subresources.insert({tag.get(), std::move(code)});
+        }
+    }
+
     void refreshIdsAndClasses(){
+        indexCurrentTags();
+        applyStyleSheets();
+    }
+    // the class index is patched per tag around a class change instead of reflattening the document
+    void unindexClasses(HTMLTag* tag){
+        for(auto& cl : tag->getStyleInputs().css_classes){
+            auto range = accessor.class_name_ptrs.equal_range(cl);
+            for(auto itr = range.first; itr != range.second;){
+                if(itr->second.get() == tag)
+                    itr = accessor.class_name_ptrs.erase(itr);
+                else
+                    itr++;
+            }
+        }
+    }
+    void indexClasses(HTMLTag* tag){
+        if(!tag->props.contains("class"))
+            return;
+        for(auto& cl : tag->getStyleInputs().css_classes)
+            accessor.class_name_ptrs.insert({cl, tag->shared_from_this()});
+    }
+    // only the tag's own classes changed, its subtree is restyled and nothing else
+    void restyleTag(HTMLTag* tag){
+        if(style_rules.empty())
+            return;
+        StyleResolver::restyleSubtree(style_rules, style_cache, tag);
+        InlineStyleRegistry::requestFlush();
+    }
+    void indexCurrentTags(){
         std::vector<std::shared_ptr<HTMLTag>> flattened_tags;
         for(auto& tag : current_tags){
             tag->flatten(flattened_tags);
@@ -57,79 +207,74 @@ public:
         std::unordered_multimap<std::string, std::shared_ptr<HTMLTag>> class_name_ptrs;
         std::unordered_map<std::string, std::shared_ptr<HTMLTag>> id_ptrs;
 
-        for(auto& tag : flattened_tags){
-            if(tag->props.contains("id"))
-                id_ptrs.insert({tag->props["id"], tag});
-            if (tag->props.contains("class"))
-                for(auto& cl : tag->getClassNames())
-                    class_name_ptrs.insert({cl, tag});
-        }
+        indexIdsAndClasses(flattened_tags, class_name_ptrs, id_ptrs);
         accessor = {.class_name_ptrs=class_name_ptrs, .id_ptrs=id_ptrs, .current_interp=this};
         scripting_interpreter.accessor = &accessor;
     }
+    void applyStyleSheets(){
+        if(style_rules.empty())
+            return;
+        StyleResolver::resolveStyles(style_rules, style_cache, current_tags);
+        InlineStyleRegistry::requestFlush();
+    }
     void renderTags(Gtk::Box* target_box, Program tags, std::string document_or_host) {
+        PreparedDocument prepared = prepareDocument(std::move(tags), std::move(document_or_host));
+        renderPreparedDocument(target_box, prepared);
+    }
+    void renderPreparedDocument(Gtk::Box* target_box, PreparedDocument& prepared) {
+        Program& tags = prepared.program;
+        std::string& document_or_host = prepared.document_or_host;
+        std::vector<std::shared_ptr<HTMLTag>>& flattened_tags = prepared.flattened_tags;
+
         PermissionContainer old_perms;
         std::string perms_file_path = "./Config/Permissions/" + document_or_host;
         if(std::filesystem::exists(perms_file_path)){
             old_perms = PermissionFileController::readPermsFromFile(perms_file_path);
         }
-        reset();
+        reset(prepared.style_generation);
         current_tags.clear();
-        for(auto& tag : tags.html_tags){
-            tag->render(target_box);
+        // images look their src up in here while rendering
+        if(prepared.preloads){
+            if(PreloadScheduler::active && PreloadScheduler::active != prepared.preloads)
+                PreloadScheduler::active->cancel();
+            PreloadScheduler::active = prepared.preloads;
         }
-        std::vector<std::shared_ptr<HTMLTag>> flattened_tags;
         for(auto& tag : tags.html_tags){
-            tag->flatten(flattened_tags);
+            tag->render(target_box);
         }
-        std::unordered_multimap<std::string, std::shared_ptr<HTMLTag>> class_name_ptrs;
-        std::unordered_map<std::string, std::shared_ptr<HTMLTag>> id_ptrs;
+        InlineStyleRegistry::flush();
 
-        for(auto& tag : flattened_tags){
-            if(tag->props.contains("id"))
-                id_ptrs.insert({tag->props["id"], tag});
-            if (tag->props.contains("class"))
-                for(auto& cl : tag->getClassNames())
-                    class_name_ptrs.insert({cl, tag});
-        }
-        accessor = { class_name_ptrs, id_ptrs, this };
+        accessor = { std::move(prepared.class_name_ptrs), std::move(prepared.id_ptrs), this };
         current_tags = tags.html_tags;
+        bool style_sheets_dirty = false;
         for(auto& tag : flattened_tags){
             if(tag->tag_information.type == Stylee){
-                auto style_tag = std::dynamic_pointer_cast<StyleTag>(tag);
-                size_t index = document_or_host.rfind('/');
-                if(index != std::string::npos){
-                    std::string new_src = document_or_host.substr(0, index) + "/" + style_tag->src;
-                    style_tag->src = std::move(new_src);
-                }
-                if(fs::exists(style_tag->src)){
-                    auto provider = Gtk::CssProvider::create();
-                    provider->load_from_path(style_tag->src);
-                    Gtk::CssProvider::add_provider_for_display(Gdk::Display::get_default(), provider,
-                     GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-                     css_providers.push_back(provider);
+                auto code_itr = prepared.subresources.find(tag.get());
+                if(code_itr != prepared.subresources.end()){
+                    StyleSheet sheet = StyleSheetParser::parseStyleSheet(std::move(code_itr->second));
+                    // pseudo classes, at rules, ... still go to gtk as they are
+                    if(!sheet.residual_css.empty()){
+                        auto provider = Gtk::CssProvider::create();
+                        provider->load_from_data(sheet.residual_css);
+                        Gtk::CssProvider::add_provider_for_display(Gdk::Display::get_default(), provider,
+                         GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+                         css_providers.push_back(provider);
+                    }
+                    style_rules.addStyleSheet(std::move(sheet));
+                    style_cache.clear();
+                    style_sheets_dirty = true;
                 }
             } else if (tag->tag_information.type == Scriptt){
                 auto script_tag = std::dynamic_pointer_cast<ScriptTag>(tag);
-                
-                size_t index = document_or_host.rfind('/');
-                if(index != std::string::npos){
-                    std::string new_src = document_or_host.substr(0, index) + "/" + script_tag->src;
-                    script_tag->src = std::move(new_src);
+                // scripts see the page styled by every sheet above them
+                if(style_sheets_dirty){
+                    applyStyleSheets();
+                    style_sheets_dirty = false;
                 }
                 
-                if(fs::exists(script_tag->src)){
-                    std::ifstream file_stream(script_tag->src, std::ios::ate);
-                    std::string code;
-
-                    size_t size = file_stream.tellg();
-
-                    code.resize(size);
-                    file_stream.seekg(0, std::ios::beg);
-                    file_stream.read(&code[0], size);
-
-                    file_stream.close();
-
+                auto code_itr = prepared.subresources.find(tag.get());
+                if(code_itr != prepared.subresources.end()){
+                    std::string& code = code_itr->second;
                     PreProcessor preprocessor;
                     std::string& src = script_tag->src;
                     if(src.rfind('/') != std::string::npos){
@@ -168,15 +313,22 @@ public:
             }
         }
         current_tags = tags.html_tags;
+        if(style_sheets_dirty)
+            applyStyleSheets();
         PermissionFileController::writePermsToFile(perms_file_path, old_perms);
     };
 
-    void reset(){
+    // keep_style_generation is the incoming document's, the generated classes it uses survive
+    void reset(uint64_t keep_style_generation){
         for(auto& prov : css_providers){
             Gtk::CssProvider::remove_provider_for_display(Gdk::Display::get_default(),
                 prov);
         }
         css_providers.clear();
+        style_rules.clear();
+        style_cache.clear();
+        if(keep_style_generation)
+            InlineStyleRegistry::reset(keep_style_generation);
 
         GarbageCollector::alive_vals.clear();
         RunTimeMemory::pool.release();
@@ -0,0 +1,248 @@
+#include "PreloadScanner.h"
+#include <stdexcept>
+
+std::shared_ptr<PreloadScheduler> PreloadScheduler::active = nullptr;
+
+std::vector<PreloadRequest> PreloadScanner::scan(const std::vector<Token>& tokens,
+    const std::string& document_or_host) {
+    std::vector<PreloadRequest> requests;
+
+    for(size_t i = 0; i < tokens.size(); i++){
+        PreloadKind kind;
+        switch(tokens[i].type){
+            case OPENSTYLE: kind = PreloadStyle; break;
+            case OPENSCRIPT: kind = PreloadScript; break;
+            case IMAGE: kind = PreloadImage; break;
+            case VIDEO: kind = PreloadVideo; break;
+            default: continue;
+        }
+
+        // props follow the tag token as PROPNAME ( PROPVAL ) pairs, same as Parser::parseProps
+        for(size_t j = i + 1; j < tokens.size() && tokens[j].type == PROPNAME; j++){
+            bool has_value = j + 1 < tokens.size() && tokens[j + 1].type == PROPVAL;
+            if(tokens[j].symbol == "src" && has_value){
+                const std::string& src = tokens[j + 1].symbol;
+                std::string url = (kind == PreloadStyle || kind == PreloadScript) ?
+                    resolveUrl(document_or_host, src) : src;
+
+                if(isRemote(url))
+                    requests.push_back({std::move(url), kind, requests.size()});
+                break;
+            }
+            if(has_value) j++;
+        }
+    }
+
+    return requests;
+};
+
+std::string PreloadScanner::resolveUrl(const std::string& document_or_host, const std::string& src) {
+    if(src.starts_with("https://") || src.starts_with("http://"))
+        return src;
+
+    size_t index = document_or_host.rfind('/');
+    if(index == std::string::npos)
+        return src;
+    return document_or_host.substr(0, index) + "/" + src;
+};
+
+bool PreloadScanner::isRemote(const std::string& url) {
+    return url.starts_with("https://") || url.starts_with("http://");
+};
+
+PreloadScheduler::PreloadScheduler(HttpManager* manager, size_t max_per_host, size_t max_in_flight):
+    http_manager(manager), max_requests_per_host(max_per_host), max_requests_in_flight(max_in_flight) {
+};
+
+int PreloadScheduler::getPriority(PreloadKind kind) {
+    switch(kind){
+        // render blocking, the page can't finish without them
+        case PreloadStyle: case PreloadScript: return 0;
+        case PreloadImage: return 1;
+        default: return 2;
+    }
+};
+
+RequestPriority PreloadScheduler::getRequestPriority(PreloadKind kind) {
+    switch(kind){
+        case PreloadStyle: case PreloadScript: return PriorityRenderBlocking;
+        case PreloadImage: return PriorityHigh;
+        default: return PriorityLow;
+    }
+};
+
+void PreloadScheduler::enqueue(std::vector<PreloadRequest> requests) {
+    std::vector<Entry*> startable;
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mut);
+        for(auto& request : requests){
+            if(entries.contains(request.url))
+                continue;
+
+            Entry entry;
+            entry.host = http_manager->getUrlInfoByUrl(request.url).host_name;
+            entry.request = std::move(request);
+
+            queue.insert({getPriority(entry.request.kind), entry.request.order, entry.request.url});
+            entries.insert({entry.request.url, std::move(entry)});
+        }
+        startable = takeStartable();
+    }
+    start(std::move(startable));
+};
+
+std::vector<PreloadScheduler::Entry*> PreloadScheduler::takeStartable() {
+    std::vector<Entry*> startable;
+    if(cancelled)
+        return startable;
+
+    for(auto itr = queue.begin(); itr != queue.end() && in_flight < max_requests_in_flight;){
+        Entry& entry = entries.at(std::get<2>(*itr));
+        size_t& host_in_flight = in_flight_per_host[entry.host];
+
+        // a busy host doesn't hold back the ones queued behind it for other hosts
+        if(host_in_flight >= max_requests_per_host){
+            itr++;
+            continue;
+        }
+
+        host_in_flight++;
+        in_flight++;
+        entry.started = true;
+        startable.push_back(&entry);
+        itr = queue.erase(itr);
+    }
+    return startable;
+};
+
+void PreloadScheduler::start(std::vector<Entry*> startable) {
+    // entries are never erased, so the pointers stay valid without the lock
+    for(Entry* entry : startable){
+        std::string url = entry->request.url;
+        auto on_done = [self = shared_from_this(), url](std::exception_ptr error, std::string result){
+            self->onFinished(url, error, std::move(result));
+        };
+
+        // the weight its stream gets when the origin speaks http/2
+        RequestPriority priority = getRequestPriority(entry->request.kind);
+
+        // images are decoded from memory, only videos need a file for Gtk::Video
+        if(entry->request.kind == PreloadVideo)
+            http_manager->getImageAsync(url, std::move(on_done), priority);
+        else
+            http_manager->getRequestAsync(url, std::move(on_done), priority);
+    }
+};
+
+void PreloadScheduler::onFinished(const std::string& url, std::exception_ptr error, std::string result) {
+    std::vector<HttpCallback> waiters;
+    std::vector<Entry*> startable;
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mut);
+        Entry& entry = entries.at(url);
+        entry.done = true;
+        entry.error = error;
+        waiters = std::move(entry.waiters);
+        entry.waiters.clear();
+        // nobody asked yet, it's kept for the first one that does
+        if(waiters.empty())
+            entry.result = result;
+        else
+            release(entry);
+
+        in_flight_per_host[entry.host]--;
+        in_flight--;
+        startable = takeStartable();
+    }
+    entry_done.notify_all();
+
+    for(auto& waiter : waiters)
+        waiter(error, result);
+    start(std::move(startable));
+};
+
+void PreloadScheduler::cancel() {
+    std::vector<std::vector<HttpCallback>> waiters;
+    std::exception_ptr error = std::make_exception_ptr(std::runtime_error("preload cancelled"));
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mut);
+        cancelled = true;
+        for(auto& [priority, order, url] : queue){
+            Entry& entry = entries.at(url);
+            entry.done = true;
+            entry.error = error;
+            waiters.push_back(std::move(entry.waiters));
+            entry.waiters.clear();
+            release(entry);
+        }
+        queue.clear();
+    }
+    entry_done.notify_all();
+
+    for(auto& entry_waiters : waiters)
+        for(auto& waiter : entry_waiters)
+            waiter(error, "");
+};
+
+void PreloadScheduler::release(Entry& entry) {
+    entry.released = true;
+    std::string().swap(entry.result);
+};
+
+bool PreloadScheduler::contains(const std::string& url) {
+    std::lock_guard<std::mutex> lock(scheduler_mut);
+    auto itr = entries.find(url);
+    return itr != entries.end() && !itr->second.released;
+};
+
+std::string PreloadScheduler::wait(const std::string& url) {
+    std::vector<Entry*> startable;
+    std::unique_lock<std::mutex> lock(scheduler_mut);
+    Entry& entry = entries.at(url);
+    if(entry.released){
+        lock.unlock();
+        return http_manager->getRequest(url);
+    }
+
+    if(!entry.started){
+        // someone is blocked on it, it jumps ahead of everything else
+        queue.erase({getPriority(entry.request.kind), entry.request.order, url});
+        queue.insert({-1, entry.request.order, url});
+        startable = takeStartable();
+
+        lock.unlock();
+        start(std::move(startable));
+        lock.lock();
+    }
+
+    entry_done.wait(lock, [&]{ return entry.done; });
+    if(entry.error)
+        std::rethrow_exception(entry.error);
+    // a cancel or another waiter may have taken it meanwhile
+    if(entry.released){
+        lock.unlock();
+        return http_manager->getRequest(url);
+    }
+    std::string result = std::move(entry.result);
+    release(entry);
+    return result;
+};
+
+bool PreloadScheduler::whenReady(const std::string& url, HttpCallback callback) {
+    std::unique_lock<std::mutex> lock(scheduler_mut);
+    auto itr = entries.find(url);
+    if(itr == entries.end() || itr->second.released)
+        return false;
+
+    if(!itr->second.done){
+        itr->second.waiters.push_back(std::move(callback));
+        return true;
+    }
+
+    std::exception_ptr error = itr->second.error;
+    std::string result = std::move(itr->second.result);
+    release(itr->second);
+    lock.unlock();
+    callback(error, std::move(result));
+    return true;
+};
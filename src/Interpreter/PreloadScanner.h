@@ -0,0 +1,93 @@
+#pragma once
+#include "Lexer.h"
+#include "../HttpManager/HttpManager.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+//
+//  The Preload Scanner Walks The Html Tokens Before The Parser Even Runs And Queues Every
+//  Remote img / script / style / video src, So All Subresources Download In Parallel While
+//  The Page Is Still Being Parsed, Styled And Rendered
+//
+
+enum PreloadKind {
+    PreloadStyle, PreloadScript, PreloadImage, PreloadVideo
+};
+
+struct PreloadRequest {
+    std::string url;
+    PreloadKind kind;
+    // position in the document, earlier images are the ones in the viewport
+    size_t order;
+};
+
+class PreloadScanner {
+public:
+    static std::vector<PreloadRequest> scan(const std::vector<Token>& tokens, const std::string& document_or_host);
+
+    // styles and scripts are relative to the document, images and videos are used as written
+    static std::string resolveUrl(const std::string& document_or_host, const std::string& src);
+    static bool isRemote(const std::string& url);
+};
+
+class PreloadScheduler : public std::enable_shared_from_this<PreloadScheduler> {
+public:
+    PreloadScheduler(HttpManager* manager, size_t max_per_host = 6, size_t max_in_flight = 16);
+
+    // the scheduler of the page on screen, gtk thread only
+    static std::shared_ptr<PreloadScheduler> active;
+
+    void enqueue(std::vector<PreloadRequest> requests);
+    // fails everything that hasn't started, in flight requests just finish into the void
+    void cancel();
+
+    // a result is handed out once and then let go of, after that ( or a cancel ) the url
+    // isn't contained anymore and the caller fetches it itself, mostly from the http cache
+    bool contains(const std::string& url);
+    // blocks until the resource is there ( promoting it if it hasn't started ), throws what the fetch threw
+    std::string wait(const std::string& url);
+    // false if the url was never scanned or is no longer held, otherwise the callback runs right
+    // away when it's done or on the http io thread when it finishes
+    bool whenReady(const std::string& url, HttpCallback callback);
+
+private:
+    struct Entry {
+        PreloadRequest request;
+        std::string host;
+        bool started = false;
+        bool done = false;
+        // the result went to whoever asked for it, or the entry was cancelled
+        bool released = false;
+        std::string result;
+        std::exception_ptr error;
+        std::vector<HttpCallback> waiters;
+    };
+    // priority, document order, url
+    typedef std::tuple<int, size_t, std::string> QueueKey;
+
+    HttpManager* http_manager;
+    size_t max_requests_per_host;
+    size_t max_requests_in_flight;
+
+    std::mutex scheduler_mut;
+    std::condition_variable entry_done;
+    std::unordered_map<std::string, Entry> entries;
+    std::set<QueueKey> queue;
+    std::unordered_map<std::string, size_t> in_flight_per_host;
+    size_t in_flight = 0;
+    bool cancelled = false;
+
+    static int getPriority(PreloadKind kind);
+    static RequestPriority getRequestPriority(PreloadKind kind);
+    // takes whatever the limits allow off the queue, the caller starts them after unlocking
+    std::vector<Entry*> takeStartable();
+    void start(std::vector<Entry*> startable);
+    void onFinished(const std::string& url, std::exception_ptr error, std::string result);
+    static void release(Entry& entry);
+};
@@ -1,25 +1,23 @@
 #include "CssManagers.h"
 #include "../Ast.h"
-#include <format>
+#include "InlineStyleRegistry.h"
 
 void BasicTagCssManagerUtil::applyCssClassesUtil(HTMLTag* target_tag, Gtk::Widget* target_widget) {
-    auto css_classes = target_tag->props.find("class");
-    if(css_classes != target_tag->props.end()){
-        for(auto& css_class : getCssClasses(css_classes->second))
-            target_widget->add_css_class(css_class);
-    }
+    for(auto& css_class : target_tag->getStyleInputs().css_classes)
+        target_widget->add_css_class(css_class);
     target_widget->add_css_class(target_tag->tag_information.html_elm_name);
+
+    if(!target_tag->sheet_style_class.empty())
+        target_widget->add_css_class(target_tag->sheet_style_class);
+    target_tag->sheet_styled_widget = target_widget;
 };
 
 void BasicTagCssManagerUtil::applyStyleUtil(HTMLTag* target_tag, Gtk::Widget* target_widget) {
-    auto style_itr = target_tag->props.find("style");
-
-    if(style_itr != target_tag->props.end()){
-        target_tag->css_provider = Gtk::CssProvider::create();
-        target_tag->css_provider->load_from_data(std::format("{} {{{}}}",
-            target_tag->tag_information.elm_name, style_itr->second));
-        target_widget->get_style_context()->add_provider(target_tag->css_provider,
-            GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    const std::string& inline_style_class = target_tag->getStyleInputs().inline_style_class;
+
+    if(!inline_style_class.empty()){
+        target_widget->add_css_class(inline_style_class);
+        InlineStyleRegistry::requestFlush();
     }
 
     normalizePositioning(target_widget);
@@ -32,14 +30,17 @@ void HTMLTagCssManager::normalizePositioning(Gtk::Widget* target_widget) {
     target_widget->set_hexpand(false);  
 };
 
-CssClassList HTMLTagCssManager::getCssClasses(std::string target_string) {
-    std::istringstream stream(target_string);
+CssClassList HTMLTagCssManager::getCssClasses(std::string_view target_string) {
+    constexpr std::string_view whitespace = " \t\n\r\f";
     CssClassList class_list;
-    std::string current_class_name;
 
-    while((stream >> current_class_name))
-        class_list.push_back(current_class_name);
-        
+    size_t begin = target_string.find_first_not_of(whitespace);
+    while(begin != std::string_view::npos){
+        size_t end = target_string.find_first_of(whitespace, begin);
+        class_list.emplace_back(target_string.substr(begin, end - begin));
+        begin = target_string.find_first_not_of(whitespace, end);
+    }
+
     return class_list;
 };
 
@@ -53,11 +54,16 @@ void ContainerTagCssManager::applyCssClasses(HTMLTag* target_tag){
     applyCssClassesUtil(target_tag, casted_tag->container_box);
 };
 
-void TextTagCssManager::applyCssClasses(HTMLTag* target_tag) {
+void TextTagCssManager::propagateProps(HTMLTag* target_tag) {
     TextTag* casted_tag = static_cast<TextTag*>(target_tag);
-    
+    if(casted_tag->props_propagated)
+        return;
+
+    auto class_names_itr = casted_tag->props.find("class");
+    auto style_itr = casted_tag->props.find("style");
+    auto width_itr = casted_tag->props.find("width");
+
     for(auto& child : casted_tag->children){
-        auto class_names_itr = casted_tag->props.find("class");
         if(child->tag_information.type == String){
             StringTag* casted_str_tag = static_cast<StringTag*>(child.get());
             if(class_names_itr != casted_tag->props.end()){
@@ -67,33 +73,35 @@ void TextTagCssManager::applyCssClasses(HTMLTag* target_tag) {
         } else {
             child->props["class"] = child->props["class"] + " " + casted_tag->tag_information.html_elm_name;
         }
+        if(style_itr != casted_tag->props.end()) { child->props["style"] = style_itr->second; };
+        if(width_itr != casted_tag->props.end()) { child->props["width"] = width_itr->second; };
+        child->invalidateStyleInputs();
     }
+
+    casted_tag->props_propagated = true;
 };
 
-void TextTagCssManager::applyStyle(HTMLTag* target_tag){
+void TextTagCssManager::applyCssClasses(HTMLTag* target_tag) {
     TextTag* casted_tag = static_cast<TextTag*>(target_tag);
+    propagateProps(target_tag);
 
-    auto style_itr = casted_tag->props.find("style");
-    auto width_itr = casted_tag->props.find("width");
+    if(!casted_tag->sheet_style_class.empty())
+        casted_tag->box->add_css_class(casted_tag->sheet_style_class);
+    casted_tag->sheet_styled_widget = casted_tag->box;
+};
 
-    for(auto& child : casted_tag->children){
-        for(auto& child : casted_tag->children){
-            if(style_itr != casted_tag->props.end()) { child->props["style"] = style_itr->second; };
-            if(width_itr != casted_tag->props.end()) { child->props["width"] = width_itr->second; };
-        }
-    }
+void TextTagCssManager::applyStyle(HTMLTag* target_tag){
+    TextTag* casted_tag = static_cast<TextTag*>(target_tag);
+    propagateProps(target_tag);
 
     normalizePositioning(casted_tag->box);
 };
 
 void StringTagCssManager::applyCssClasses(HTMLTag* target_tag){
     StringTag* casted_tag = static_cast<StringTag*>(target_tag);
-    auto itr = casted_tag->props.find("class");
 
-    if(itr != casted_tag->props.end()){
-        for(auto& css_class : getCssClasses(itr->second)){
-            casted_tag->lab->add_css_class(css_class);
-        }
+    for(auto& css_class : casted_tag->getStyleInputs().css_classes){
+        casted_tag->lab->add_css_class(css_class);
     }
 
     casted_tag->lab->add_css_class(casted_tag->parent_class_name);
@@ -101,14 +109,11 @@ void StringTagCssManager::applyCssClasses(HTMLTag* target_tag){
 
 void StringTagCssManager::applyStyle(HTMLTag* target_tag){
     StringTag* casted_tag = static_cast<StringTag*>(target_tag);
-    auto style_itr = casted_tag->props.find("style");
+    const std::string& inline_style_class = casted_tag->getStyleInputs().inline_style_class;
 
-    if(style_itr != casted_tag->props.end()){
-        casted_tag->css_provider = Gtk::CssProvider::create();
-        casted_tag->css_provider->load_from_data(std::format("{} {{{}}}",
-            casted_tag->tag_information.elm_name, style_itr->second));
-        casted_tag->lab->get_style_context()->add_provider(casted_tag->css_provider,
-            GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    if(!inline_style_class.empty()){
+        casted_tag->lab->add_css_class(inline_style_class);
+        InlineStyleRegistry::requestFlush();
     }
 
     normalizePositioning(casted_tag->lab);
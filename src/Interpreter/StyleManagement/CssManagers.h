@@ -1,6 +1,7 @@
 #pragma once
 #include <gtkmm/widget.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class HTMLTag;
@@ -10,8 +11,12 @@ class HTMLTagCssManager {
 public:
      virtual void applyCssClasses(HTMLTag* target_tag) {};
      virtual void applyStyle(HTMLTag* target_tag) {};
+     // pushes props down to the children before they are indexed or rendered,
+     // must be safe to call more than once and off the gtk thread
+     virtual void propagateProps(HTMLTag* target_tag) {};
      void normalizePositioning(Gtk::Widget* target_widget);
-     CssClassList getCssClasses(std::string target_string);
+     // splits a class="" attribute on whitespace
+     static CssClassList getCssClasses(std::string_view target_string);
 };
 class BasicTagCssManagerUtil : public HTMLTagCssManager {
 public:
@@ -27,6 +32,7 @@ class TextTagCssManager : public HTMLTagCssManager {
 public:
      void applyCssClasses(HTMLTag* target_tag) override;
      void applyStyle(HTMLTag* target_tag) override;
+     void propagateProps(HTMLTag* target_tag) override;
 };
 class StringTagCssManager : public HTMLTagCssManager {
 public:
@@ -0,0 +1,114 @@
+#include "InlineStyleRegistry.h"
+#include "../../StyleSheets/StyleSheetParser.h"
+#include <gdkmm/display.h>
+#include <glibmm/main.h>
+#include <gtk/gtk.h>
+
+std::mutex InlineStyleRegistry::registry_mut;
+std::unordered_map<std::string, InlineStyleRegistry::GeneratedClass> InlineStyleRegistry::style_classes[GeneratedStyleLayerCount] = {};
+std::string InlineStyleRegistry::layer_rules[GeneratedStyleLayerCount] = {};
+bool InlineStyleRegistry::layer_dirty[GeneratedStyleLayerCount] = {};
+uint64_t InlineStyleRegistry::next_class_id[GeneratedStyleLayerCount] = {};
+uint64_t InlineStyleRegistry::current_generation = 0;
+bool InlineStyleRegistry::flush_requested = false;
+Glib::RefPtr<Gtk::CssProvider> InlineStyleRegistry::providers[GeneratedStyleLayerCount] = {};
+
+uint64_t InlineStyleRegistry::beginGeneration() {
+    std::lock_guard<std::mutex> lock(registry_mut);
+    return ++current_generation;
+};
+
+std::string InlineStyleRegistry::getClassForStyle(const std::string& style,
+    GeneratedStyleLayer layer) {
+    std::lock_guard<std::mutex> lock(registry_mut);
+
+    auto& classes = style_classes[layer];
+    auto itr = classes.find(style);
+    if(itr != classes.end()){
+        itr->second.generation = current_generation;
+        return itr->second.class_name;
+    }
+
+    // a counter instead of the hash itself, so two styles can never collide on a class
+    std::string class_name = class_prefixes[layer] + std::to_string(next_class_id[layer]++);
+    // the attribute is page controlled, only what parses as declarations goes into the rule
+    std::string rule = "." + class_name + " {" + StyleSheetParser::sanitizeDeclarations(style) + "}\n";
+    layer_rules[layer] += rule;
+    layer_dirty[layer] = true;
+    classes.insert({style, {class_name, std::move(rule), current_generation}});
+
+    return class_name;
+};
+
+void InlineStyleRegistry::flush() {
+    std::string rules[GeneratedStyleLayerCount];
+    bool dirty[GeneratedStyleLayerCount] = {};
+    {
+        std::lock_guard<std::mutex> lock(registry_mut);
+        flush_requested = false;
+        for(int layer = 0; layer < GeneratedStyleLayerCount; layer++){
+            if(!layer_dirty[layer])
+                continue;
+            dirty[layer] = true;
+            rules[layer] = layer_rules[layer];
+            layer_dirty[layer] = false;
+        }
+    }
+
+    for(int layer = 0; layer < GeneratedStyleLayerCount; layer++){
+        if(!dirty[layer])
+            continue;
+
+        if(!providers[layer]){
+            providers[layer] = Gtk::CssProvider::create();
+            // sheet styles sit with the page stylesheets, inline styles one above so they win like in html
+            Gtk::CssProvider::add_provider_for_display(Gdk::Display::get_default(), providers[layer],
+                GTK_STYLE_PROVIDER_PRIORITY_APPLICATION + layer);
+        }
+        providers[layer]->load_from_data(rules[layer]);
+    }
+};
+
+void InlineStyleRegistry::requestFlush() {
+    {
+        std::lock_guard<std::mutex> lock(registry_mut);
+        if(flush_requested || (!layer_dirty[SheetStyleLayer] && !layer_dirty[InlineStyleLayer]))
+            return;
+        flush_requested = true;
+    }
+    // high idle runs before the frame clock redraws, so there's no unstyled frame
+    Glib::signal_idle().connect_once(&InlineStyleRegistry::flush, Glib::PRIORITY_HIGH_IDLE);
+};
+
+void InlineStyleRegistry::reset(uint64_t keep_generation) {
+    {
+        std::lock_guard<std::mutex> lock(registry_mut);
+        for(int layer = 0; layer < GeneratedStyleLayerCount; layer++){
+            auto& classes = style_classes[layer];
+            size_t previous_count = classes.size();
+            std::erase_if(classes, [keep_generation](const auto& entry){
+                return entry.second.generation < keep_generation;
+            });
+            if(classes.size() == previous_count)
+                continue;
+
+            layer_rules[layer].clear();
+            for(auto& [style, generated] : classes)
+                layer_rules[layer] += generated.rule;
+            layer_dirty[layer] = true;
+        }
+    }
+    flush();
+};
+
+size_t InlineStyleRegistry::getUniqueStyleCount() {
+    std::lock_guard<std::mutex> lock(registry_mut);
+    return style_classes[InlineStyleLayer].size() + style_classes[SheetStyleLayer].size();
+};
+
+size_t InlineStyleRegistry::getProviderCount() {
+    size_t count = 0;
+    for(auto& provider : providers)
+        if(provider) count++;
+    return count;
+};
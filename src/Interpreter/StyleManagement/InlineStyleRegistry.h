@@ -0,0 +1,62 @@
+#pragma once
+#include <glibmm/refptr.h>
+#include <gtkmm/cssprovider.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//
+//  Inline style="" Attributes Are Deduplicated Here, Every Unique Style String
+//  Gets A Generated Class Name And One Rule In Its Layer's Provider,
+//  So Gtk Parses Css O(unique styles) Times Instead Of Once Per Element
+//  Styles Computed From <style> Sheets Share The Same Machinery One Layer Below
+//
+
+enum GeneratedStyleLayer {
+    SheetStyleLayer, InlineStyleLayer, GeneratedStyleLayerCount
+};
+
+class InlineStyleRegistry {
+public:
+    static constexpr const char* class_prefixes[GeneratedStyleLayerCount] = {
+        "sigma-sheet-", "sigma-inline-"
+    };
+
+    // thread safe, called before a document is prepared. styles asked for from then on belong to
+    // its generation, the one reset keeps when that document is rendered
+    static uint64_t beginGeneration();
+
+    // thread safe, can be called while a page is prepared on a worker thread
+    static std::string getClassForStyle(const std::string& style,
+        GeneratedStyleLayer layer = InlineStyleLayer);
+
+    // gtk thread only, reloads each layer's provider if it got new rules
+    static void flush();
+    // gtk thread only, flushes right before the next redraw
+    static void requestFlush();
+    // gtk thread only, forgets every style last asked for before keep_generation and reloads the providers
+    static void reset(uint64_t keep_generation);
+
+    static size_t getUniqueStyleCount();
+    static size_t getProviderCount();
+
+private:
+    struct GeneratedClass {
+        std::string class_name;
+        std::string rule;
+        uint64_t generation;
+    };
+
+    static std::mutex registry_mut;
+    static std::unordered_map<std::string, GeneratedClass> style_classes[GeneratedStyleLayerCount];
+    // every live rule of the layer, what its provider is loaded from
+    static std::string layer_rules[GeneratedStyleLayerCount];
+    static bool layer_dirty[GeneratedStyleLayerCount];
+    // class names are never reused, a widget of the old page can't pick up a new page's rule
+    static uint64_t next_class_id[GeneratedStyleLayerCount];
+    static uint64_t current_generation;
+    static bool flush_requested;
+    // one per layer, created on the first flush that has rules for it
+    static Glib::RefPtr<Gtk::CssProvider> providers[GeneratedStyleLayerCount];
+};
@@ -1,8 +1,12 @@
 #include "TagRenderers.h"
 #include "../Ast.h"
-#include "../../Concurrency/ThreadPool.h"
 #include "../../HttpManager/HttpManager.h"
-#include <boost/asio/post.hpp>
+#include "../PreloadScanner.h"
+#include "../../Images/DecodedImageCache.h"
+#include <gtkmm/listitem.h>
+#include <gtkmm/noselection.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/signallistitemfactory.h>
 #include <iostream>
 
 void HTMLTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
@@ -38,9 +42,100 @@ void ContainerTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
     css_manager->applyCssClasses(casted_tag);
     css_manager->applyStyle(casted_tag);
 
+    if(shouldVirtualize(casted_tag)){
+        renderVirtualized(casted_tag);
+        return;
+    }
+
     renderChildren(casted_tag, casted_tag->container_box);
 };
 
+void ContainerTagRenderer::unRender(HTMLTag* target_tag) {
+    ContainerTag* casted_tag = static_cast<ContainerTag*>(target_tag);
+    HTMLTagRenderer::unRender(target_tag);
+
+    casted_tag->materialized_rows.clear();
+    casted_tag->virtual_rows.reset();
+    casted_tag->list_view = nullptr;
+};
+
+bool ContainerTagRenderer::shouldVirtualize(ContainerTag* target_tag) {
+    auto itr = target_tag->props.find("virtualize");
+    if(itr != target_tag->props.end())
+        return itr->second != "false";
+
+    return target_tag->children.size() >= virtualization_threshold;
+};
+
+void ContainerTagRenderer::renderVirtualized(ContainerTag* casted_tag) {
+    int viewport_height = default_viewport_height;
+    auto height_itr = casted_tag->props.find("height");
+    if(height_itr != casted_tag->props.end()){
+        try { viewport_height = std::stoi(height_itr->second); }
+        catch(std::exception&) {}
+    }
+
+    auto viewport = Gtk::manage(new Gtk::ScrolledWindow);
+    viewport->set_policy(Gtk::PolicyType::NEVER, Gtk::PolicyType::AUTOMATIC);
+    viewport->set_propagate_natural_width(true);
+    viewport->set_min_content_height(viewport_height);
+
+    // rows are recycled by the list view, bind materializes the child at the row position
+    // and unbind tears it down again, so only the visible range ( + overscan ) is alive
+    auto factory = Gtk::SignalListItemFactory::create();
+    factory->signal_setup().connect([](const Glib::RefPtr<Gtk::ListItem>& list_item){
+        list_item->set_child(*Gtk::manage(new Gtk::Box(Gtk::Orientation::VERTICAL)));
+    });
+    factory->signal_bind().connect([casted_tag](const Glib::RefPtr<Gtk::ListItem>& list_item){
+        Gtk::Box* row_box = static_cast<Gtk::Box*>(list_item->get_child());
+        size_t position = list_item->get_position();
+        if(position >= casted_tag->children.size())
+            return;
+
+        // render puts back what scripts did to the row while it was off screen, its text lives
+        // on the tags and HTMLTag::render rebinds their event handlers
+        auto& row_tag = casted_tag->children[position];
+        row_tag->render(row_box);
+        casted_tag->materialized_rows[row_box] = row_tag;
+    });
+    factory->signal_unbind().connect([casted_tag](const Glib::RefPtr<Gtk::ListItem>& list_item){
+        Gtk::Box* row_box = static_cast<Gtk::Box*>(list_item->get_child());
+        auto itr = casted_tag->materialized_rows.find(row_box);
+        if(itr != casted_tag->materialized_rows.end()){
+            // skip children that were freed, or moved and rendered somewhere else, since the bind
+            auto row_tag = itr->second.lock();
+            if(row_tag && row_tag->tag_information.parent_widget == row_box)
+                row_tag->unRender();
+            casted_tag->materialized_rows.erase(itr);
+        }
+        // some tags only know their widget after an async load, drop whatever is left
+        while(Gtk::Widget* leftover = row_box->get_first_child())
+            row_box->remove(*leftover);
+    });
+
+    casted_tag->virtual_rows = Gtk::StringList::create({});
+    syncVirtualizedChildren(casted_tag, 0, 0, casted_tag->children.size());
+
+    casted_tag->list_view = Gtk::manage(new Gtk::ListView(
+        Gtk::NoSelection::create(casted_tag->virtual_rows), factory));
+    viewport->set_child(*casted_tag->list_view);
+    casted_tag->container_box->append(*viewport);
+};
+
+bool ContainerTagRenderer::syncVirtualizedChildren(HTMLTag* target_tag, size_t position, size_t removed,
+    size_t added) {
+    ContainerTag* casted_tag = dynamic_cast<ContainerTag*>(target_tag);
+    if(!casted_tag || !casted_tag->virtual_rows)
+        return false;
+
+    // the items are only placeholders, the row position is the index into children.
+    // rows outside the spliced range keep their item, and the children shifted along with them,
+    // so the list view only binds the new ones
+    std::vector<Glib::ustring> rows(added);
+    casted_tag->virtual_rows->splice(position, removed, rows);
+    return true;
+};
+
 void TextTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
     TextTag* casted_tag = static_cast<TextTag*>(target_tag);
     casted_tag->tag_information.parent_widget = target_box;
@@ -81,8 +176,35 @@ void ButtonTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
 };
 void VideoTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
     VideoTag* casted_tag = static_cast<VideoTag*>(target_tag);
-    casted_tag->vid = Gtk::manage(new Gtk::Video(casted_tag->props["src"]));
-    std::cout << casted_tag->props["src"];
+    casted_tag->vid = Gtk::manage(new Gtk::Video);
+    const std::string& src = casted_tag->props["src"];
+
+    // Gtk::Video only plays local files, remote ones are downloaded by the preload scanner first
+    if(!casted_tag->disp){
+        casted_tag->disp = std::make_unique<Glib::Dispatcher>();
+        casted_tag->disp->connect([casted_tag](){
+            std::string path;
+            {
+                std::lock_guard<std::mutex> lock(casted_tag->handoff->mut);
+                path = casted_tag->handoff->path;
+            }
+            // the download can finish after the tag was unrendered
+            if(casted_tag->vid)
+                casted_tag->vid->set_filename(path);
+        });
+        std::lock_guard<std::mutex> lock(casted_tag->handoff->mut);
+        casted_tag->handoff->disp = casted_tag->disp.get();
+    }
+    bool preloaded = PreloadScheduler::active && PreloadScheduler::active->whenReady(src,
+        [handoff = casted_tag->handoff](std::exception_ptr error, std::string path){
+            if(error)
+                return;
+            std::lock_guard<std::mutex> lock(handoff->mut);
+            handoff->path = std::move(path);
+            handoff->notify();
+        });
+    if(!preloaded)
+        casted_tag->vid->set_filename(src);
 
     casted_tag->tag_information.parent_widget = target_box;
     casted_tag->tag_information.current_widget = casted_tag->vid;
@@ -92,9 +214,17 @@ void VideoTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
     css_manager->applyCssClasses(casted_tag);
     css_manager->applyStyle(casted_tag);
 };
+void VideoTagRenderer::unRender(HTMLTag* target_tag) {
+    HTMLTagRenderer::unRender(target_tag);
+    static_cast<VideoTag*>(target_tag)->vid = nullptr;
+};
 void InputTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
     InputTag* casted_tag = static_cast<InputTag*>(target_tag);
     casted_tag->input = Gtk::manage(new Gtk::Entry);
+    casted_tag->input->set_text(casted_tag->text);
+    casted_tag->input->signal_changed().connect([casted_tag](){
+        casted_tag->text = casted_tag->input->get_text();
+    });
 
     casted_tag->tag_information.parent_widget = target_box;
     casted_tag->tag_information.current_widget = casted_tag->input;
@@ -108,20 +238,79 @@ void ImageTagRenderer::render(HTMLTag* target_tag, Gtk::Box* target_box) {
     ImageTag* casted_tag = static_cast<ImageTag*>(target_tag);
     casted_tag->tag_information.parent_widget = target_box;
     casted_tag->image = Gtk::manage(new Gtk::Image);
+    // the widget is the tag's from the start, so an unRender before the decode lands still removes it
+    casted_tag->tag_information.current_widget = casted_tag->image;
     casted_tag->tag_information.parent_widget->append(*casted_tag->image);
-    casted_tag->disp.connect([casted_tag](){
-        casted_tag->image->set(casted_tag->img_path);
-    });
-    boost::asio::post(Concurrency::pool, [casted_tag, this](){
-        if(casted_tag->props.contains("src")){
-            const std::string pathh = HttpExposer::current_http_manager->getImage(
-                casted_tag->props["src"]);
-        
-            casted_tag->tag_information.current_widget = casted_tag->image;
-            css_manager->applyCssClasses(casted_tag);
-            css_manager->applyStyle(casted_tag);
-            casted_tag->img_path = pathh;
-            casted_tag->disp.emit();
+    css_manager->applyCssClasses(casted_tag);
+    css_manager->applyStyle(casted_tag);
+    // one dispatcher for the tag's lifetime, re-renders reuse it
+    if(!casted_tag->disp){
+        casted_tag->disp = std::make_unique<Glib::Dispatcher>();
+        casted_tag->disp->connect([casted_tag](){
+            Glib::RefPtr<Gdk::Texture> texture;
+            {
+                std::lock_guard<std::mutex> lock(casted_tag->handoff->mut);
+                texture = casted_tag->handoff->texture;
+            }
+            // the decode can land after the tag was unrendered
+            if(texture && casted_tag->image)
+                casted_tag->image->set(texture);
+        });
+        std::lock_guard<std::mutex> lock(casted_tag->handoff->mut);
+        casted_tag->handoff->disp = casted_tag->disp.get();
+    }
+    auto src_itr = casted_tag->props.find("src");
+    if(src_itr == casted_tag->props.end())
+        return;
+
+    // the width / height attributes are the display size, nothing is decoded bigger than that
+    int width = 0, height = 0;
+    auto width_itr = casted_tag->props.find("width");
+    auto height_itr = casted_tag->props.find("height");
+    try { if(width_itr != casted_tag->props.end()) width = std::stoi(width_itr->second); } catch(...) {}
+    try { if(height_itr != casted_tag->props.end()) height = std::stoi(height_itr->second); } catch(...) {}
+
+    // runs on whichever thread finished the decode, the tag is only reached through the handoff
+    auto on_decoded = [handoff = casted_tag->handoff](Glib::RefPtr<Gdk::Texture> texture){
+        if(!texture)
+            return;
+        std::lock_guard<std::mutex> lock(handoff->mut);
+        handoff->texture = std::move(texture);
+        handoff->notify();
+    };
+
+    // every <img> with this src and size shares one fetch, one decode and one texture
+    std::string src = src_itr->second;
+    DecodedImageCache::shared.get(src, width, height, [src, width, height](ImageLoadDone done){
+        if(HttpExposer::current_http_manager == nullptr){
+            // no internet mode, only local images can show up
+            ImageDecoder::decodeFileAsync(src, width, height, [done](Glib::RefPtr<Gdk::Texture> texture){
+                done(std::move(texture), 0);
+            });
+            return;
         }
-    });
+
+        // the fetch is a coroutine on the http io thread, the bytes go from its buffer to a
+        // pool thread for decoding, no file in between and no decode on the gtk thread
+        auto on_loaded = [width, height, done](std::exception_ptr error, std::string bytes){
+            if(error){
+                done({}, 0);
+                return;
+            }
+            size_t fetched_bytes = bytes.size();
+            ImageDecoder::decodeAsync(std::move(bytes), width, height,
+                [done, fetched_bytes](Glib::RefPtr<Gdk::Texture> texture){
+                    done(std::move(texture), fetched_bytes);
+                });
+        };
+
+        // most images were queued by the preload scanner while the page was still parsing
+        if(PreloadScheduler::active && PreloadScheduler::active->whenReady(src, on_loaded))
+            return;
+        HttpExposer::current_http_manager->getRequestAsync(src, std::move(on_loaded));
+    }, std::move(on_decoded));
+};
+void ImageTagRenderer::unRender(HTMLTag* target_tag) {
+    HTMLTagRenderer::unRender(target_tag);
+    static_cast<ImageTag*>(target_tag)->image = nullptr;
 };
\ No newline at end of file
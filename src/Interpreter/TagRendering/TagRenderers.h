@@ -1,5 +1,6 @@
 #pragma once
 #include <gtkmm/box.h>
+#include <cstddef>
 #include <memory>
 #include "../StyleManagement/CssManagers.h"
 
@@ -9,6 +10,7 @@
 //
 
 class HTMLTag;
+class ContainerTag;
 typedef std::unique_ptr<HTMLTagCssManager> HTMLTagCssManagerPtr;
 
 class HTMLTagRenderer {
@@ -25,12 +27,28 @@ public:
     void renderChildren(HTMLTag* target_children_tag, Gtk::Box* box);
 };
 
+//
+//  Containers With Many Children ( Or With virtualize="true" ) Are Rendered
+//  Through A Gtk::ListView, Only The Visible Rows Get Real Widgets
+//
+
 class ContainerTagRenderer : public HTMLTagRenderer {
 public:
+    static constexpr size_t virtualization_threshold = 500;
+    static constexpr int default_viewport_height = 400;
+
     ContainerTagRenderer(): HTMLTagRenderer(
         std::make_unique<ContainerTagCssManager>()) {};
 
     void render(HTMLTag* target_tag, Gtk::Box* target_box) override;
+    void unRender(HTMLTag* target_tag) override;
+
+    bool shouldVirtualize(ContainerTag* target_tag);
+    void renderVirtualized(ContainerTag* target_tag);
+
+    // mirrors children[position, position + removed) being replaced by added new children,
+    // returns false if the tag isn't a virtualized container
+    static bool syncVirtualizedChildren(HTMLTag* target_tag, size_t position, size_t removed, size_t added);
 };
 
 class TextTagRenderer : public HTMLTagRenderer {
@@ -56,6 +74,7 @@ public:
         std::make_unique<ImageTagCssManager>()) {};
 
     void render(HTMLTag* target_tag, Gtk::Box* target_box) override;
+    void unRender(HTMLTag* target_tag) override;
 };
 
 class ButtonTagRenderer : public HTMLTagRenderer {
@@ -80,4 +99,5 @@ public:
         std::make_unique<VideoTagCssManager>()) {};
 
     void render(HTMLTag* target_tag, Gtk::Box* target_box);
+    void unRender(HTMLTag* target_tag) override;
 };
\ No newline at end of file
@@ -1,6 +1,12 @@
 #include "Cryptography.h"
+#include "../Concurrency/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/post.hpp>
+#include <condition_variable>
 #include <cstring>
-#include <iomanip>
+#include <memory>
+#include <mutex>
 #include <openssl/bn.h>
 #include <openssl/pem.h>
 #include <openssl/rand.h>
@@ -8,79 +14,169 @@
 #include <openssl/sha.h>
 #include <openssl/evp.h>
 #include <openssl/types.h>
-#include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
-std::string Crypto::Sha256(std::string target_str) {
-    unsigned char result[SHA256_DIGEST_LENGTH];
+// the contexts the one shot functions reuse, one set per thread so they never need a lock
+struct ThreadContexts {
     EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
-    EVP_DigestInit_ex(md_ctx, EVP_sha256(), nullptr);
-    EVP_DigestUpdate(md_ctx, &target_str[0], target_str.size());
-    unsigned int result_size;
-    EVP_DigestFinal_ex(md_ctx, &result[0], &result_size);
-    EVP_MD_CTX_free(md_ctx);
+    EVP_CIPHER_CTX* cipher_ctx = EVP_CIPHER_CTX_new();
+
+    ~ThreadContexts() {
+        EVP_MD_CTX_free(md_ctx);
+        EVP_CIPHER_CTX_free(cipher_ctx);
+    };
+};
+
+static ThreadContexts& getThreadContexts() {
+    thread_local ThreadContexts contexts;
+    return contexts;
+};
+
+static void checkAes256Key(size_t key_size) {
+    if(key_size != 32)
+        throw std::runtime_error("AES256 keys are 32 bytes, got " + std::to_string(key_size));
+};
+
+const EVP_MD* Crypto::getDigest(HashAlgorithm algorithm) {
+    // fetched once, openssl 3 otherwise looks the implementation up again on every init
+    static const EVP_MD* sha256 = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+    static const EVP_MD* sha512 = EVP_MD_fetch(nullptr, "SHA512", nullptr);
+    if(algorithm == HashSha512)
+        return sha512 ? sha512 : EVP_sha512();
+    return sha256 ? sha256 : EVP_sha256();
+};
+
+const EVP_CIPHER* Crypto::getAes256Cipher() {
+    static const EVP_CIPHER* cipher = EVP_CIPHER_fetch(nullptr, "AES-256-CBC", nullptr);
+    return cipher ? cipher : EVP_aes_256_cbc();
+};
 
-    std::ostringstream sstrea;
-    for(int i = 0; i < SHA256_DIGEST_LENGTH; i++){
-        sstrea << std::hex << std::setw(2) << std::setfill('0') << (int)result[i];
+std::string Crypto::toHex(const unsigned char* data, size_t size) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string hex(size * 2, '\0');
+    for(size_t i = 0; i < size; i++){
+        hex[i * 2] = digits[data[i] >> 4];
+        hex[i * 2 + 1] = digits[data[i] & 0x0f];
     }
-    return sstrea.str();
+    return hex;
 };
 
-std::string Crypto::Sha512(std::string target_str){
-    unsigned char result[SHA512_DIGEST_LENGTH];
+std::string Crypto::hash(HashAlgorithm algorithm, std::string_view target_str) {
+    unsigned char result[EVP_MAX_MD_SIZE];
     unsigned int result_size = 0;
-    EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
-    EVP_DigestInit_ex(md_ctx, EVP_sha512(), nullptr);
-    EVP_DigestUpdate(md_ctx, &target_str[0], target_str.size());
+    EVP_MD_CTX* md_ctx = getThreadContexts().md_ctx;
+    EVP_DigestInit_ex(md_ctx, getDigest(algorithm), nullptr);
+    EVP_DigestUpdate(md_ctx, target_str.data(), target_str.size());
     EVP_DigestFinal_ex(md_ctx, result, &result_size);
-    EVP_MD_CTX_free(md_ctx);
 
-    std::ostringstream sstrea;
-    for(int i = 0; i < SHA512_DIGEST_LENGTH; i++){
-        sstrea << std::hex << std::setw(2) << std::setfill('0') << (int)result[i];
-    }
-    return sstrea.str();
+    return toHex(result, result_size);
+};
+
+std::string Crypto::Sha256(std::string_view target_str) {
+    return hash(HashSha256, target_str);
 };
 
-std::vector<unsigned char> Crypto::Aes256(std::string target_str, std::vector<unsigned char> key) {
-    std::vector<unsigned char> iv(16);
+std::string Crypto::Sha512(std::string_view target_str){
+    return hash(HashSha512, target_str);
+};
+
+std::vector<std::string> Crypto::hashBatch(HashAlgorithm algorithm, const std::vector<std::string_view>& messages) {
+    std::vector<std::string> results(messages.size());
+    size_t total_bytes = 0;
+    for(auto& message : messages)
+        total_bytes += message.size();
+
+    // below this handing the work out costs more than hashing it here
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    if(total_bytes < 256 * 1024 || messages.size() < 2 || workers == 1){
+        for(size_t i = 0; i < messages.size(); i++)
+            results[i] = hash(algorithm, messages[i]);
+        return results;
+    }
+
+    // helpers and the caller take blocks of messages off a shared counter until there are none left.
+    // the caller only waits on blocks someone is already hashing, so a busy pool can't stall it,
+    // and a helper that starts late finds nothing and leaves without touching the messages
+    struct BatchState {
+        std::atomic<size_t> next_index = 0;
+        size_t pending;
+        std::mutex state_mut;
+        std::condition_variable all_done;
+    };
+    auto state = std::make_shared<BatchState>();
+    state->pending = messages.size();
+    size_t block_size = std::clamp<size_t>(messages.size() / (workers * 8), 1, 256);
+
+    auto work = [state, algorithm, block_size, count = messages.size(), &messages, &results](){
+        while(true){
+            size_t first = state->next_index.fetch_add(block_size);
+            if(first >= count)
+                return;
+            size_t last = std::min(first + block_size, count);
+            for(size_t i = first; i < last; i++)
+                results[i] = hash(algorithm, messages[i]);
+
+            std::lock_guard<std::mutex> lock(state->state_mut);
+            state->pending -= last - first;
+            if(state->pending == 0)
+                state->all_done.notify_all();
+        }
+    };
+
+    size_t blocks = (messages.size() + block_size - 1) / block_size;
+    size_t helpers = std::min(workers, blocks) - 1;
+    for(size_t i = 0; i < helpers; i++)
+        boost::asio::post(Concurrency::pool, work);
+    work();
 
-    RAND_bytes(iv.data(), 16);
+    std::unique_lock<std::mutex> lock(state->state_mut);
+    state->all_done.wait(lock, [&]{ return state->pending == 0; });
+    return results;
+};
+
+std::vector<unsigned char> Crypto::Aes256(std::string_view target_str, const std::vector<unsigned char>& key) {
+    checkAes256Key(key.size());
+    // the iv goes first, written straight into place
+    std::vector<unsigned char> out(16 + target_str.size() + 16);
+    RAND_bytes(out.data(), 16);
 
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr,
-        key.data(), iv.data());
-    std::vector<unsigned char> out(target_str.size() + 16);
+    EVP_CIPHER_CTX* ctx = getThreadContexts().cipher_ctx;
+    EVP_CIPHER_CTX_reset(ctx);
+    EVP_EncryptInit_ex(ctx, getAes256Cipher(), nullptr,
+        key.data(), out.data());
     int len = 0;
     int cipher_len = 0;
-    const unsigned char* actual_in = reinterpret_cast<const unsigned char*>(target_str.c_str());
-    EVP_EncryptUpdate(ctx, out.data(), &len,  actual_in, target_str.size());
+    const unsigned char* actual_in = reinterpret_cast<const unsigned char*>(target_str.data());
+    EVP_EncryptUpdate(ctx, out.data() + 16, &len,  actual_in, target_str.size());
     cipher_len += len;
-    EVP_EncryptFinal_ex(ctx, out.data() + len, &len);
+    EVP_EncryptFinal_ex(ctx, out.data() + 16 + cipher_len, &len);
     cipher_len += len;
 
-    out.resize(cipher_len);
-    out.insert(out.begin(), iv.begin(), iv.end());
-
+    out.resize(16 + cipher_len);
     return out;
 };
 
-std::string Crypto::decryptAes256(std::vector<unsigned char> cipher, std::vector<unsigned char> key){
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key.data(), cipher.data());
+std::string Crypto::decryptAes256(const unsigned char* cipher, size_t cipher_size, const std::vector<unsigned char>& key){
+    checkAes256Key(key.size());
+    if(cipher_size < 16)
+        throw std::runtime_error("AES256 cipher is too short to hold its iv");
+
+    EVP_CIPHER_CTX* ctx = getThreadContexts().cipher_ctx;
+    EVP_CIPHER_CTX_reset(ctx);
+    EVP_DecryptInit_ex(ctx, getAes256Cipher(), nullptr, key.data(), cipher);
     int out_len = 0;
     int total_len = 0;
-    std::vector<unsigned char> result(cipher.size() + 16);
-    EVP_DecryptUpdate(ctx, result.data(), &out_len, cipher.data() + 16, cipher.size() - 16);
+    std::string result(cipher_size, '\0');
+    unsigned char* result_data = reinterpret_cast<unsigned char*>(result.data());
+    EVP_DecryptUpdate(ctx, result_data, &out_len, cipher + 16, cipher_size - 16);
     total_len += out_len;
-    EVP_DecryptFinal_ex(ctx, result.data() + out_len, &out_len);
+    EVP_DecryptFinal_ex(ctx, result_data + out_len, &out_len);
     total_len += out_len;
-    EVP_CIPHER_CTX_free(ctx);
-    
-    std::string str(reinterpret_cast<const char*>(result.data()), total_len);
-    
-    return str;
+
+    result.resize(total_len);
+    return result;
 }
 
 RsaResult Crypto::Rsa(std::string target_str) {
@@ -106,12 +202,7 @@ RsaResult Crypto::Rsa(std::string target_str) {
     RSA_free(rs);
     EVP_PKEY_CTX_free(ctx);
 
-    std::ostringstream sstrea;
-    for(int i = 0; i < out_len; i++){
-        sstrea << std::hex << std::setw(2) << std::setfill('0') << (int)result[i];
-    }
-
-    return { sstrea.str() };
+    return { toHex(result.data(), out_len) };
 };
 
 std::vector<unsigned char> Crypto::genAes256Key() {
@@ -119,4 +210,104 @@ std::vector<unsigned char> Crypto::genAes256Key() {
     RAND_bytes(key.data(), 32);
 
     return key;
-};
\ No newline at end of file
+};
+
+Hasher::Hasher(HashAlgorithm algorithm): md_ctx(EVP_MD_CTX_new()), md(Crypto::getDigest(algorithm)) {
+    EVP_DigestInit_ex(md_ctx, md, nullptr);
+};
+
+Hasher::~Hasher() {
+    EVP_MD_CTX_free(md_ctx);
+};
+
+void Hasher::update(const void* data, size_t size) {
+    EVP_DigestUpdate(md_ctx, data, size);
+};
+
+std::string Hasher::digest() {
+    unsigned char result[EVP_MAX_MD_SIZE];
+    unsigned int result_size = 0;
+    EVP_DigestFinal_ex(md_ctx, result, &result_size);
+    // same context, ready for the next message
+    EVP_DigestInit_ex(md_ctx, md, nullptr);
+    return Crypto::toHex(result, result_size);
+};
+
+AesStream::AesStream(const unsigned char* key_data, size_t key_size, bool encrypting_stream):
+    cipher_ctx(EVP_CIPHER_CTX_new()), encrypting(encrypting_stream), key(key_data, key_data + key_size) {
+    checkAes256Key(key_size);
+    iv.reserve(16);
+    if(encrypting){
+        iv.resize(16);
+        RAND_bytes(iv.data(), 16);
+    }
+};
+
+AesStream::~AesStream() {
+    OPENSSL_cleanse(key.data(), key.size());
+    EVP_CIPHER_CTX_free(cipher_ctx);
+};
+
+void AesStream::start() {
+    if(encrypting)
+        EVP_EncryptInit_ex(cipher_ctx, Crypto::getAes256Cipher(), nullptr, key.data(), iv.data());
+    else
+        EVP_DecryptInit_ex(cipher_ctx, Crypto::getAes256Cipher(), nullptr, key.data(), iv.data());
+    OPENSSL_cleanse(key.data(), key.size());
+    started = true;
+};
+
+std::vector<unsigned char> AesStream::update(const unsigned char* data, size_t size) {
+    if(finished)
+        throw std::runtime_error("AES256 stream is already finished");
+
+    std::vector<unsigned char> out;
+    if(!started){
+        if(encrypting){
+            out = iv;
+        } else {
+            // the iv can come split over several pieces
+            size_t taken = std::min(size, 16 - iv.size());
+            iv.insert(iv.end(), data, data + taken);
+            data += taken;
+            size -= taken;
+            if(iv.size() < 16)
+                return out;
+        }
+        start();
+    }
+
+    size_t offset = out.size();
+    out.resize(offset + size + 16);
+    int len = 0;
+    if(encrypting)
+        EVP_EncryptUpdate(cipher_ctx, out.data() + offset, &len, data, size);
+    else
+        EVP_DecryptUpdate(cipher_ctx, out.data() + offset, &len, data, size);
+    out.resize(offset + len);
+    return out;
+};
+
+std::vector<unsigned char> AesStream::finish() {
+    if(finished)
+        throw std::runtime_error("AES256 stream is already finished");
+    // an empty message still gets its iv and a block of padding
+    std::vector<unsigned char> out;
+    if(!started){
+        if(!encrypting)
+            throw std::runtime_error("AES256 cipher is too short to hold its iv");
+        out = iv;
+        start();
+    }
+    finished = true;
+
+    size_t offset = out.size();
+    out.resize(offset + 16);
+    int len = 0;
+    int ok = encrypting ? EVP_EncryptFinal_ex(cipher_ctx, out.data() + offset, &len) :
+        EVP_DecryptFinal_ex(cipher_ctx, out.data() + offset, &len);
+    if(!ok)
+        throw std::runtime_error("AES256 decryption failed, wrong key or cut off cipher");
+    out.resize(offset + len);
+    return out;
+};
@@ -1,5 +1,8 @@
 #pragma once
+#include <cstddef>
+#include <openssl/types.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -7,12 +10,71 @@ struct RsaResult {
     std::string cipher;
 };
 
+enum HashAlgorithm {
+    HashSha256, HashSha512
+};
+
+// a digest fed piece by piece, for messages that never sit in memory whole.
+// digest() starts it over, so one hasher can go through any number of messages
+class Hasher {
+public:
+    explicit Hasher(HashAlgorithm algorithm = HashSha256);
+    ~Hasher();
+    Hasher(const Hasher&) = delete;
+    Hasher& operator=(const Hasher&) = delete;
+
+    void update(const void* data, size_t size);
+    void update(std::string_view data) { update(data.data(), data.size()); };
+    // hex digest of everything since the last one
+    std::string digest();
+
+private:
+    EVP_MD_CTX* md_ctx;
+    const EVP_MD* md;
+};
+
+// aes-256-cbc over a message that arrives in pieces. the output is laid out like Crypto::Aes256
+// ( the iv, then the cipher ) so the pieces joined decrypt with decryptAes256 and the other way around
+class AesStream {
+public:
+    // throws std::runtime_error unless the key is 32 bytes
+    AesStream(const unsigned char* key, size_t key_size, bool encrypting);
+    ~AesStream();
+    AesStream(const AesStream&) = delete;
+    AesStream& operator=(const AesStream&) = delete;
+
+    std::vector<unsigned char> update(const unsigned char* data, size_t size);
+    // the last ( padded ) block, nothing more goes through the stream after it.
+    // throws std::runtime_error when decrypting with the wrong key or a cut off cipher
+    std::vector<unsigned char> finish();
+    bool isFinished() const { return finished; };
+
+private:
+    EVP_CIPHER_CTX* cipher_ctx;
+    bool encrypting;
+    bool started = false;
+    bool finished = false;
+    // held until the iv is known, a decrypting stream reads it off the front of the cipher
+    std::vector<unsigned char> key;
+    std::vector<unsigned char> iv;
+
+    void start();
+};
+
 class Crypto {
 public:
-    static std::string Sha256(std::string target_str);
-    static std::string Sha512(std::string target_str);
-    static std::vector<unsigned char> Aes256(std::string target_str, std::vector<unsigned char> key);
-    static std::string decryptAes256(std::vector<unsigned char> cipher, std::vector<unsigned char> key);
+    static std::string Sha256(std::string_view target_str);
+    static std::string Sha512(std::string_view target_str);
+    static std::string hash(HashAlgorithm algorithm, std::string_view target_str);
+    // every message hashed, spread over the thread pool when there's enough to be worth it
+    static std::vector<std::string> hashBatch(HashAlgorithm algorithm, const std::vector<std::string_view>& messages);
+
+    static std::vector<unsigned char> Aes256(std::string_view target_str, const std::vector<unsigned char>& key);
+    static std::string decryptAes256(const unsigned char* cipher, size_t cipher_size, const std::vector<unsigned char>& key);
     static std::vector<unsigned char> genAes256Key();
     static RsaResult Rsa(std::string target_str);
-};
\ No newline at end of file
+
+    static std::string toHex(const unsigned char* data, size_t size);
+    static const EVP_MD* getDigest(HashAlgorithm algorithm);
+    static const EVP_CIPHER* getAes256Cipher();
+};
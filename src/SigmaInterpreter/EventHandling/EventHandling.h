@@ -9,6 +9,7 @@ public:
     LambdaVal* handler;
     virtual void bindEventToWidget(Gtk::Widget* target_widget, SigmaInterpreter* executor) = 0;
     Event(LambdaVal* evt_handler): handler(evt_handler) {};
+    virtual ~Event() = default;
 };
 
 class ClickEvent : public Event {
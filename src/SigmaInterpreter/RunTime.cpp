@@ -1,10 +1,12 @@
 #include "RunTime.h"
 #include "GarbageCollector/GarbageCollector.h"
 #include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 
@@ -24,6 +26,15 @@ CharVal* RunTimeFactory::makeChar(char ch) {
 ArrayVal* RunTimeFactory::makeArray(std::vector<RunTimeVal*> vec){
     return makeVal<ArrayVal>(std::move(vec));
 };
+TypedArrayVal* RunTimeFactory::makeTypedArray(TypedArrayVal::ElementKind kind, size_t size){
+    return makeVal<TypedArrayVal>(kind, size);
+};
+MapVal* RunTimeFactory::makeMap(){
+    return makeVal<MapVal>();
+};
+SetVal* RunTimeFactory::makeSet(){
+    return makeVal<SetVal>();
+};
 ObjectVal* RunTimeFactory::makeStruct(std::unordered_map<std::string,
     RunTimeVal*> vals) {
     return makeVal<ObjectVal>(std::move(vals));
@@ -74,6 +85,90 @@ RunTimeVal* ArrayVal::clone() {
         return val->clone();
     });
     return RunTimeFactory::makeArray(new_arr); };
+RunTimeVal* TypedArrayVal::clone() {
+    TypedArrayVal* copy = RunTimeFactory::makeTypedArray(kind, 0);
+    copy->floats = floats;
+    copy->ints = ints;
+    return copy;
+};
+std::string TypedArrayVal::getString() {
+    std::string str = "[ ";
+    for(size_t i = 0; i < length(); i++){
+        if(i != 0) str += ", ";
+        str += std::to_string(get(i));
+    }
+    str += " ]";
+    return str;
+};
+int32_t TypedArrayVal::toInt32(double num) {
+    if(!std::isfinite(num))
+        return 0;
+    double wrapped = std::fmod(std::trunc(num), 4294967296.0);
+    if(wrapped < 0) wrapped += 4294967296.0;
+    return static_cast<int32_t>(static_cast<uint32_t>(wrapped));
+};
+CollectionKey CollectionKeyHelper::toKey(RunTimeVal* val) {
+    switch(val->type){
+        case NumType: {
+            double num = static_cast<NumVal*>(val)->num;
+            if(std::isnan(num))
+                throw std::runtime_error("NaN can't be used as a key");
+            // -0 and 0 are the same key
+            return num == 0 ? 0.0 : num;
+        }
+        case StringType: return static_cast<StringVal*>(val)->str;
+        case CharType: return static_cast<CharVal*>(val)->ch;
+        case BoolType: return static_cast<BoolVal*>(val)->boolean;
+        default:
+            throw std::runtime_error("only numbers, strings, chars and bools can be used as keys");
+    }
+};
+RunTimeVal* CollectionKeyHelper::fromKey(const CollectionKey& key) {
+    if(auto num = std::get_if<double>(&key)) return RunTimeFactory::makeNum(*num);
+    if(auto boolean = std::get_if<bool>(&key)) return RunTimeFactory::makeBool(*boolean);
+    if(auto ch = std::get_if<char>(&key)) return RunTimeFactory::makeChar(*ch);
+    return RunTimeFactory::makeString(std::get<std::string>(key));
+};
+std::string CollectionKeyHelper::toString(const CollectionKey& key) {
+    if(auto num = std::get_if<double>(&key)) return std::to_string(*num);
+    if(auto boolean = std::get_if<bool>(&key)) return *boolean ? "true" : "false";
+    if(auto ch = std::get_if<char>(&key)) return std::string(1, *ch);
+    return std::get<std::string>(key);
+};
+RunTimeVal* MapVal::clone() {
+    MapVal* copy = RunTimeFactory::makeMap();
+    for(auto& [key, val] : entries){
+        copy->entries.insert({key, val ? val->clone() : nullptr});
+    }
+    return copy;
+};
+std::string MapVal::getString() {
+    std::string str = "{ ";
+    bool first = true;
+    for(auto& [key, val] : entries){
+        if(!first) str += ", ";
+        first = false;
+        str += CollectionKeyHelper::toString(key) + ": " + (val ? val->getString() : "<Null>");
+    }
+    str += " }";
+    return str;
+};
+RunTimeVal* SetVal::clone() {
+    SetVal* copy = RunTimeFactory::makeSet();
+    copy->keys = keys;
+    return copy;
+};
+std::string SetVal::getString() {
+    std::string str = "{ ";
+    bool first = true;
+    for(auto& key : keys){
+        if(!first) str += ", ";
+        first = false;
+        str += CollectionKeyHelper::toString(key);
+    }
+    str += " }";
+    return str;
+};
 RunTimeVal* ObjectVal::clone() { 
     std::unordered_map<std::string, RunTimeVal*> valss;
     for(auto& [val_name, value] : vals){
@@ -92,15 +187,24 @@ BinaryVal* RunTimeFactory::makeBinary(
     return makeVal<BinaryVal>(std::move(d));
 };
 
+BinaryVal* RunTimeFactory::makeBinaryView(
+    std::shared_ptr<const void> owner, const unsigned char* d, size_t size
+) {
+    return makeVal<BinaryVal>(std::move(owner), d, size);
+};
+
 RunTimeVal* BinaryVal::clone() {
+    if(isView())
+        return RunTimeFactory::makeBinaryView(view_owner, view_data, view_size);
     return RunTimeFactory::makeBinary(binary_data);
 }
 
 std::string BinaryVal::getString(){
     std::ostringstream sstrea;
 
-    for(int i = 0; i < binary_data.size(); i++){
-        sstrea << std::hex << std::setw(2) << std::setfill('0') << (int)binary_data[i];
+    const unsigned char* bytes = data();
+    for(size_t i = 0; i < size(); i++){
+        sstrea << std::hex << std::setw(2) << std::setfill('0') << (int)bytes[i];
     }
     return sstrea.str();
 }
@@ -3,6 +3,7 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -11,6 +12,8 @@
 #include <vector>
 #include "SigmaAst.h"
 #include <unordered_map>
+#include <unordered_set>
+#include <variant>
 #include <memory_resource>
 #include "../Interpreter/Ast.h"
 
@@ -20,7 +23,7 @@ class SigmaInterpreter;
 enum RunTimeValType {
     NumType, StringType, CharType, BoolType, LambdaType, ArrayType, StructType, ReturnType,
     BreakType, ContinueType, NativeFunctionType, RefrenceType, BinaryType, HtmlType, AnyType,
-    NullType
+    NullType, TypedArrayType, MapType, SetType
 };
 
 
@@ -242,6 +245,109 @@ public:
     
 };
 
+// numbers packed into one buffer rather than a NumVal each, 8 bytes an element for a
+// Float64Array and 4 for an Int32Array, and nothing inside for the gc to walk
+class TypedArrayVal : public RunTimeVal {
+public:
+    enum ElementKind {
+        Float64Elements, Int32Elements
+    };
+
+    ElementKind kind;
+    // only the one matching kind is used
+    std::vector<double> floats;
+    std::vector<int32_t> ints;
+
+    TypedArrayVal(ElementKind element_kind, size_t size): RunTimeVal(TypedArrayType), kind(element_kind) {
+        if(kind == Float64Elements) floats.resize(size);
+        else ints.resize(size);
+    };
+
+    size_t length() const { return kind == Float64Elements ? floats.size() : ints.size(); };
+    double get(size_t index) const { return kind == Float64Elements ? floats[index] : ints[index]; };
+    void set(size_t index, double num) {
+        if(kind == Float64Elements) floats[index] = num;
+        else ints[index] = toInt32(num);
+    };
+    void resize(size_t size) {
+        if(kind == Float64Elements) floats.resize(size);
+        else ints.resize(size);
+    };
+    // wraps around like js does, nan and the infinities become 0
+    static int32_t toInt32(double num);
+    // the most elements a typed array can be created or resized to
+    static constexpr double max_length = 4294967295.0;
+    // whether a script number can be used as a length, NaN and the infinities can't
+    static bool isValidLength(double num) { return num >= 0 && num <= max_length; };
+
+    size_t getSize() override { return sizeof(TypedArrayVal); };
+    size_t getAlignment() override { return alignof(TypedArrayVal); };
+
+    void setValue(RunTimeVal* val) override {
+        auto other = static_cast<TypedArrayVal*>(val);
+        kind = other->kind;
+        floats = other->floats;
+        ints = other->ints;
+    }
+    RunTimeVal* clone() override;
+    std::string getString() override;
+};
+
+// what a Map or Set is keyed by, any primitive, compared by value
+using CollectionKey = std::variant<double, bool, char, std::string>;
+
+struct CollectionKeyHelper {
+    // throws std::runtime_error for anything that isn't a number, string, char or bool and for NaN
+    static CollectionKey toKey(RunTimeVal* val);
+    // a fresh primitive holding the key, strings come back unwrapped
+    static RunTimeVal* fromKey(const CollectionKey& key);
+    // printed the way the primitive would print itself
+    static std::string toString(const CollectionKey& key);
+};
+
+class MapVal : public RunTimeVal {
+public:
+    std::unordered_map<CollectionKey, RunTimeVal*> entries;
+
+    MapVal(): RunTimeVal(MapType) {};
+
+    size_t getSize() override { return sizeof(MapVal); };
+    size_t getAlignment() override { return alignof(MapVal); };
+
+    void markChildren() override {
+        for(auto& [key, val] : entries){
+            if(val) val->mark();
+        }
+    };
+    void unMarkChildren() override {
+        for(auto& [key, val] : entries){
+            if(val) val->unMark();
+        }
+    };
+
+    void setValue(RunTimeVal* val) override {
+        entries = static_cast<MapVal*>(val)->entries;
+    }
+    RunTimeVal* clone() override;
+    std::string getString() override;
+};
+
+class SetVal : public RunTimeVal {
+public:
+    std::unordered_set<CollectionKey> keys;
+
+    SetVal(): RunTimeVal(SetType) {};
+
+    size_t getSize() override { return sizeof(SetVal); };
+    size_t getAlignment() override { return alignof(SetVal); };
+
+    void setValue(RunTimeVal* val) override {
+        keys = static_cast<SetVal*>(val)->keys;
+    }
+    RunTimeVal* clone() override;
+    std::string getString() override;
+};
+
 class ObjectVal : public RunTimeVal {
 public:
     std::unordered_map<std::string, RunTimeVal*> vals;
@@ -353,9 +459,23 @@ public:
 
 class BinaryVal : public RunTimeVal {
 public:
+    // the bytes when the value owns them, empty for a view
     std::vector<unsigned char> binary_data;
-
-    BinaryVal(std::vector<unsigned char> d): RunTimeVal(BinaryType), binary_data(d) {};
+    // a view reads bytes that belong to something else ( a mapped file ) and keeps that alive,
+    // views are read only so clones just share them
+    std::shared_ptr<const void> view_owner;
+    const unsigned char* view_data = nullptr;
+    size_t view_size = 0;
+
+    BinaryVal(std::vector<unsigned char> d): RunTimeVal(BinaryType), binary_data(std::move(d)) {};
+    BinaryVal(std::shared_ptr<const void> owner, const unsigned char* d, size_t size): RunTimeVal(BinaryType),
+        view_owner(std::move(owner)), view_data(d), view_size(size) {};
+
+    bool isView() const { return view_owner != nullptr; };
+    const unsigned char* data() const { return isView() ? view_data : binary_data.data(); };
+    size_t size() const { return isView() ? view_size : binary_data.size(); };
+    // a copy of the bytes, for apis that want a vector
+    std::vector<unsigned char> toVector() const { return std::vector<unsigned char>(data(), data() + size()); };
 
     size_t getSize() override { return sizeof(BinaryVal); };
     size_t getAlignment() override { return alignof(BinaryVal); };
@@ -421,5 +541,13 @@ public:
     static BinaryVal* makeBinary(
         std::vector<unsigned char> d
     );
+    static MapVal* makeMap();
+    static SetVal* makeSet();
+    static TypedArrayVal* makeTypedArray(
+        TypedArrayVal::ElementKind kind, size_t size
+    );
+    static BinaryVal* makeBinaryView(
+        std::shared_ptr<const void> owner, const unsigned char* d, size_t size
+    );
     static HtmlElementVal* makeHtmlElement(HTMLTag* tag);
 };
\ No newline at end of file
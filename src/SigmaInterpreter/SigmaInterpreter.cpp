@@ -14,6 +14,9 @@
 #include "StandardLibrary/TypeWrappers/StringWrapper.h"
 #include "Util/Util.h"
 #include "StandardLibrary/TypeWrappers/ArrayWrapper.h"
+#include "StandardLibrary/TypeWrappers/TypedArrayWrapper.h"
+#include "StandardLibrary/TypeWrappers/MapWrapper.h"
+#include "StandardLibrary/TypeWrappers/SetWrapper.h"
 
 SigmaInterpreter::SigmaInterpreter(){
     current_window = nullptr;
@@ -28,12 +31,13 @@ std::unordered_map<RunTimeValType, std::string> SigmaInterpreter::type_to_string
     {BoolType, "Bool"}, {LambdaType, "Lambda"}, {ArrayType, "Array"},
     {StructType, "Struct"}, {NativeFunctionType, "CompiledFunction"},
     {RefrenceType, "Refrence"}, {BinaryType, "Binary"}, {HtmlType, "HtmlElement"},
-    {AnyType, "Any"}
+    {AnyType, "Any"}, {TypedArrayType, "TypedArray"}, {MapType, "Map"}, {SetType, "Set"}
 };
 
 
 std::unordered_set<RunTimeValType> SigmaInterpreter::non_copyable_types = {
-        StructType, LambdaType, StringType, ArrayType, BinaryType, NativeFunctionType, HtmlType
+        StructType, LambdaType, StringType, ArrayType, BinaryType, NativeFunctionType, HtmlType,
+        TypedArrayType, MapType, SetType
 };
 
 void SigmaInterpreter::initialize(){
@@ -74,9 +78,15 @@ void SigmaInterpreter::initialize(){
 
     ArrayWrapper::initializeWrapper();
     StringWrapper::initializeWrapper();
+    TypedArrayWrapper::initializeWrapper();
+    MapWrapper::initializeWrapper();
+    SetWrapper::initializeWrapper();
 
     garbageCollectionRestricter.registerWrapperTypeFunctions(ArrayWrapper::funcs);
     garbageCollectionRestricter.registerWrapperTypeFunctions(StringWrapper::funcs);
+    garbageCollectionRestricter.registerWrapperTypeFunctions(TypedArrayWrapper::funcs);
+    garbageCollectionRestricter.registerWrapperTypeFunctions(MapWrapper::funcs);
+    garbageCollectionRestricter.registerWrapperTypeFunctions(SetWrapper::funcs);
 }
 
 void SigmaInterpreter::cleanUpBeforeExecuting() {
@@ -516,6 +526,13 @@ RunTimeValue SigmaInterpreter::
             return val;
         }
 
+        // straight out of the buffer, the only NumVal made is the one handed back
+        if(val->type == TypedArrayType){
+            auto real_val = static_cast<TypedArrayVal*>(val);
+            if(!(real_num->num >= 0 && real_num->num < real_val->length())) throw std::runtime_error("out of bounds array index");
+            return RunTimeFactory::makeNum(real_val->get(static_cast<size_t>(real_num->num)));
+        }
+
         if(val->type != ArrayType) throw std::runtime_error("operator [] must be used on an array");
         auto real_val = static_cast<ArrayVal*>(val);
 
@@ -570,6 +587,15 @@ RunTimeValue SigmaInterpreter::evaluateIndexReInitStatement(IndexReInitStatement
             static_cast<CharVal*>(evaluate(stmt->val))->ch; 
         return nullptr;
     }
+    // stored in place, no value is kept around for the gc
+    if(val->type == TypedArrayType){
+        auto latest_val = static_cast<TypedArrayVal*>(val);
+        if(!(latest_num->num >= 0 && latest_num->num < latest_val->length())) throw std::runtime_error("out of bounds array index");
+        auto new_val = evaluate(stmt->val);
+        if(new_val->type != NumType) throw std::runtime_error("typed arrays can only hold numbers");
+        latest_val->set(static_cast<size_t>(latest_num->num), static_cast<NumVal*>(new_val)->num);
+        return nullptr;
+    }
     auto latest_val = static_cast<ArrayVal*>(val);
 
     if(latest_val->vals[static_cast<int>(latest_num->num)] && latest_val->vals[static_cast<int>(latest_num->num)]->type == RefrenceType){
@@ -0,0 +1,43 @@
+#include "CollectionLib.h"
+#include "../TypeWrappers/MapWrapper.h"
+#include "../TypeWrappers/SetWrapper.h"
+#include "../../Util/Util.h"
+
+ObjectVal* CollectionLib::getMapStruct() {
+    std::unordered_map<std::string, RunTimeVal*> vals = {
+        {"create", RunTimeFactory::makeNativeFunction(&CollectionLib::createMap, {})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+ObjectVal* CollectionLib::getSetStruct() {
+    std::unordered_map<std::string, RunTimeVal*> vals = {
+        {"create", RunTimeFactory::makeNativeFunction(&CollectionLib::createSet, {})},
+        {"from", RunTimeFactory::makeNativeFunction(&CollectionLib::setFromArray, {{"array", ArrayType}})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+RunTimeValue CollectionLib::createMap(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    return MapWrapper::genObject(RunTimeFactory::makeMap());
+};
+
+RunTimeValue CollectionLib::createSet(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    return SetWrapper::genObject(RunTimeFactory::makeSet());
+};
+
+RunTimeValue CollectionLib::setFromArray(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    auto array = static_cast<ArrayVal*>(args[0]);
+    SetVal* set = RunTimeFactory::makeSet();
+    set->keys.reserve(array->vals.size());
+
+    for(RunTimeVal* val : array->vals){
+        // elements are kept wrapped, unlike args
+        Util::SigmaInterpreterHelper::cvtToPrimitiveIfWrapper(&val);
+        set->keys.insert(CollectionKeyHelper::toKey(val));
+    }
+
+    return SetWrapper::genObject(set);
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include "../StdLib.h"
+
+// Map And Set, Hashed Containers Keyed By Any Primitive ( Number, String, Char, Bool )
+class CollectionLib {
+public:
+    static ObjectVal* getMapStruct();
+    static ObjectVal* getSetStruct();
+
+    static RunTimeValue createMap(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    static RunTimeValue createSet(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    // a set of the distinct values of an array
+    static RunTimeValue setFromArray(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+};
@@ -1,6 +1,20 @@
 #include "CryptoLib.h"
 #include "../../Cryptography.h"
+#include "../TypeWrappers/ArrayWrapper.h"
 #include "../TypeWrappers/StringWrapper.h"
+#include <memory>
+#include <stdexcept>
+
+static HashAlgorithm getHashAlgorithm(std::vector<RunTimeValue>& args, size_t index) {
+    if(args.size() <= index)
+        return HashSha256;
+    const std::string& name = static_cast<StringVal*>(args[index])->str;
+    if(name == "SHA256")
+        return HashSha256;
+    if(name == "SHA512")
+        return HashSha512;
+    throw std::runtime_error("unknown hash algorithm " + name + ", excepted SHA256 or SHA512");
+};
 
 ObjectVal* CryptoLib::getStruct(){
     std::unordered_map<std::string, RunTimeVal*> vals = {
@@ -9,6 +23,10 @@ ObjectVal* CryptoLib::getStruct(){
         {"AES256Encrypt", RunTimeFactory::makeNativeFunction(&CryptoLib::Aes256Wrapper, {{"message", StringType}, {"key", BinaryType}})},
         {"AES256Decrypt", RunTimeFactory::makeNativeFunction(&CryptoLib::Aes256DecryptWrapper, {{"cipher", BinaryType}, {"key", BinaryType}})},
         {"AES256GenKey", RunTimeFactory::makeNativeFunction(&CryptoLib::Aes256GenKeyWrapper, {})},
+        {"hasher", RunTimeFactory::makeNativeFunction(&CryptoLib::hasherWrapper, {{"algorithm", StringType, true}})},
+        {"hashBatch", RunTimeFactory::makeNativeFunction(&CryptoLib::hashBatchWrapper, {{"messages", ArrayType}, {"algorithm", StringType, true}})},
+        {"AES256Encryptor", RunTimeFactory::makeNativeFunction(&CryptoLib::Aes256EncryptorWrapper, {{"key", BinaryType}})},
+        {"AES256Decryptor", RunTimeFactory::makeNativeFunction(&CryptoLib::Aes256DecryptorWrapper, {{"key", BinaryType}})},
     };
 
     return RunTimeFactory::makeStruct(std::move(vals));
@@ -23,8 +41,8 @@ RunTimeValue CryptoLib::Sha512Wrapper(std::vector<RunTimeValue>& args, SigmaInte
 };
 RunTimeValue CryptoLib::Aes256Wrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
     std::vector<unsigned char> res = Crypto::Aes256(dynamic_cast<StringVal*>(args[0])->str,
-        dynamic_cast<BinaryVal*>(args[1])->binary_data);
-    return RunTimeFactory::makeBinary(res);
+        dynamic_cast<BinaryVal*>(args[1])->toVector());
+    return RunTimeFactory::makeBinary(std::move(res));
 };
 
 RunTimeValue CryptoLib::Aes256GenKeyWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
@@ -32,7 +50,90 @@ RunTimeValue CryptoLib::Aes256GenKeyWrapper(std::vector<RunTimeValue>& args, Sig
 };
 
 RunTimeValue CryptoLib::Aes256DecryptWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    auto cipher = dynamic_cast<BinaryVal*>(args[0]);
     return  StringWrapper::genObject(RunTimeFactory::makeString(Crypto::decryptAes256(
-        dynamic_cast<BinaryVal*>(args[0])->binary_data,
-         dynamic_cast<BinaryVal*>(args[1])->binary_data)));
-};
\ No newline at end of file
+        cipher->data(), cipher->size(),
+         dynamic_cast<BinaryVal*>(args[1])->toVector())));
+};
+
+std::string_view CryptoLib::getBytes(RunTimeVal* val, const std::string& func_name) {
+    if(val->type == StringType)
+        return static_cast<StringVal*>(val)->str;
+    if(val->type == BinaryType){
+        auto binary = static_cast<BinaryVal*>(val);
+        return std::string_view(reinterpret_cast<const char*>(binary->data()), binary->size());
+    }
+    // array elements aren't unwrapped on the way in like args are
+    if(val->type == StructType){
+        auto object = static_cast<ObjectVal*>(val);
+        if(object->vals.contains("is_primitive"))
+            return getBytes(object->vals["primitive"], func_name);
+    }
+    throw std::runtime_error(func_name + " Excepts a String or a Binary");
+};
+
+RunTimeValue CryptoLib::hasherWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    auto hasher = std::make_shared<Hasher>(getHashAlgorithm(args, 0));
+
+    std::unordered_map<std::string, RunTimeValue> vals = {
+        {"update", RunTimeFactory::makeNativeFunction([hasher](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            hasher->update(getBytes(args[0], "update"));
+            return nullptr;
+        }, {{"data", AnyType}})},
+        {"digest", RunTimeFactory::makeNativeFunction([hasher](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            return StringWrapper::genObject(RunTimeFactory::makeString(hasher->digest()));
+        }, {})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+RunTimeValue CryptoLib::hashBatchWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    auto messages_array = static_cast<ArrayVal*>(args[0]);
+    HashAlgorithm algorithm = getHashAlgorithm(args, 1);
+
+    // views into the script's values, nothing is copied before it's hashed
+    std::vector<std::string_view> messages;
+    messages.reserve(messages_array->vals.size());
+    for(auto val : messages_array->vals)
+        messages.push_back(getBytes(val, "hashBatch"));
+
+    std::vector<std::string> digests = Crypto::hashBatch(algorithm, messages);
+    ArrayVal* results = RunTimeFactory::makeArray({});
+    results->vals.reserve(digests.size());
+    for(auto& digest : digests)
+        results->vals.push_back(StringWrapper::genObject(RunTimeFactory::makeString(std::move(digest))));
+
+    return ArrayWrapper::genObject(results);
+};
+
+ObjectVal* CryptoLib::makeAesStream(BinaryVal* key, bool encrypting) {
+    auto strea = std::make_shared<AesStream>(key->data(), key->size(), encrypting);
+
+    // encrypting gives Binary pieces, decrypting gives String pieces, like the one shot functions
+    auto wrap = [encrypting](std::vector<unsigned char> out) -> RunTimeValue {
+        if(encrypting)
+            return RunTimeFactory::makeBinary(std::move(out));
+        return StringWrapper::genObject(RunTimeFactory::makeString(std::string(out.begin(), out.end())));
+    };
+
+    std::unordered_map<std::string, RunTimeValue> vals = {
+        {"update", RunTimeFactory::makeNativeFunction([strea, wrap](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            std::string_view data = getBytes(args[0], "update");
+            return wrap(strea->update(reinterpret_cast<const unsigned char*>(data.data()), data.size()));
+        }, {{"data", AnyType}})},
+        {"finish", RunTimeFactory::makeNativeFunction([strea, wrap](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            return wrap(strea->finish());
+        }, {})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+RunTimeValue CryptoLib::Aes256EncryptorWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    return makeAesStream(static_cast<BinaryVal*>(args[0]), true);
+};
+
+RunTimeValue CryptoLib::Aes256DecryptorWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    return makeAesStream(static_cast<BinaryVal*>(args[0]), false);
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "../StdLib.h"
+#include <string_view>
 
 class CryptoLib : public StdLib {
 public:
@@ -10,4 +11,18 @@ public:
     static RunTimeValue Aes256Wrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
     static RunTimeValue Aes256DecryptWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
     static RunTimeValue Aes256GenKeyWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
-};
\ No newline at end of file
+
+    // an incremental hash, update ( String or Binary ) as the message arrives then digest.
+    // digest starts it over so one hasher can do many messages
+    static RunTimeValue hasherWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    // hex digests of an array of messages, hashed in parallel
+    static RunTimeValue hashBatchWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    // aes-256 streams, update / finish, whose output joined matches AES256Encrypt / AES256Decrypt
+    static RunTimeValue Aes256EncryptorWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    static RunTimeValue Aes256DecryptorWrapper(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+
+private:
+    // the bytes of a String or a Binary, anything else throws naming func_name
+    static std::string_view getBytes(RunTimeVal* val, const std::string& func_name);
+    static ObjectVal* makeAesStream(BinaryVal* key, bool encrypting);
+};
@@ -37,6 +37,9 @@ RunTimeVal* DocumentLib::getStruct() {
        {"removeElement", RunTimeFactory::makeNativeFunction(&DocumentLib::removeElement, {{"parent", HtmlType}, {"element", HtmlType}})},
        {"createElementsFromHtml", RunTimeFactory::makeNativeFunction(&DocumentLib::createElementsFromHtml, {{"html_text", StringType}})},
        {"clearChildren", RunTimeFactory::makeNativeFunction(&DocumentLib::clearChildren, {{"element", HtmlType}})},
+       {"setClass", RunTimeFactory::makeNativeFunction(&DocumentLib::setClass, {{"element", HtmlType}, {"class_names", StringType}})},
+       {"addClass", RunTimeFactory::makeNativeFunction(&DocumentLib::addClass, {{"element", HtmlType}, {"class_name", StringType}})},
+       {"removeClass", RunTimeFactory::makeNativeFunction(&DocumentLib::removeClass, {{"element", HtmlType}, {"class_name", StringType}})},
        {"connectEventHandler", RunTimeFactory::makeNativeFunction(&DocumentLib::connectEventHandler, {{"element", HtmlType}, {"event_type", StringType}, {"handler", LambdaType}})}
     };
 
@@ -58,8 +61,13 @@ RunTimeValue DocumentLib::setElementInnerHtml(COMPILED_FUNC_ARGS){
     auto ast_val = pars.produceAst(tokens);
     for(auto& child : html_elm->target_tag->children)
         child->unRender();
+    size_t removed = html_elm->target_tag->children.size();
     html_elm->target_tag->setChildren(ast_val.html_tags);
-    interpret.renderTags(dynamic_cast<Gtk::Box*>(html_elm->target_tag->tag_information.current_widget), ast_val, "");
+    // an element that isn't rendered ( an off screen virtualized row ) renders its new children once it is
+    Gtk::Box* target_box = dynamic_cast<Gtk::Box*>(html_elm->target_tag->tag_information.current_widget);
+    if(!ContainerTagRenderer::syncVirtualizedChildren(html_elm->target_tag, 0, removed, ast_val.html_tags.size())
+        && target_box)
+        interpret.renderTags(target_box, ast_val, "");
     interpreter->accessor->current_interp->refreshIdsAndClasses();
     return nullptr;
 };
@@ -82,10 +90,7 @@ RunTimeVal* DocumentLib::setOnClick(COMPILED_FUNC_ARGS) {
     LambdaVal* lambda_val = static_cast<LambdaVal*>(args[1]);
     interpreter->garbageCollectionRestricter.registerEventHandler(lambda_val);
 
-    Gtk::Button* btn = static_cast<Gtk::Button*>(elm_val->target_tag->tag_information.current_widget);
-    btn->signal_clicked().connect([lambda_val, interpreter](){
-        interpreter->evaluateAnonymousLambdaCall(lambda_val, {});
-    });
+    elm_val->target_tag->addEvent(std::make_unique<ClickEvent>(lambda_val), interpreter);
     return nullptr;
 };
 
@@ -104,7 +109,7 @@ RunTimeVal* DocumentLib::getText(COMPILED_FUNC_ARGS) {
         ));
     } else if(tag->tag_information.type == Input){
         return  StringWrapper::genObject(RunTimeFactory::makeString(
-            static_cast<InputTag*>(tag)->input->get_text()
+            static_cast<InputTag*>(tag)->text
         ));
     }
 
@@ -119,14 +124,19 @@ RunTimeVal* DocumentLib::setText(COMPILED_FUNC_ARGS) {
     if(txt_tags.contains(tag->tag_information.type)){
         StringTag* str_tag = static_cast<StringTag*>(tag->children[0].get());
         str_tag->str = target_str;
-        str_tag->lab->set_text(target_str);
+        // off screen tags only keep the text, their next render picks it up
+        if(str_tag->tag_information.current_widget)
+            str_tag->lab->set_text(target_str);
     } else if (tag->tag_information.type == Button){
         ButtonTag* btn_tag = static_cast<ButtonTag*>(tag);
         btn_tag->str = target_str;
-        btn_tag->button->set_label(target_str);
+        if(btn_tag->tag_information.current_widget)
+            btn_tag->button->set_label(target_str);
     } else if(tag->tag_information.type == Input){
         InputTag* input_tag = static_cast<InputTag*>(tag);
-        input_tag->input->set_text(target_str);
+        input_tag->text = target_str;
+        if(input_tag->tag_information.current_widget)
+            input_tag->input->set_text(target_str);
     }
 
     return nullptr;
@@ -168,7 +178,10 @@ RunTimeVal* DocumentLib::appendChild(COMPILED_FUNC_ARGS) {
     HtmlElementVal* appended_elm = static_cast<HtmlElementVal*>(args[1]);
 
     target_elm->target_tag->children.push_back(std::shared_ptr<HTMLTag>(appended_elm->target_tag));
-    appended_elm->target_tag->render(dynamic_cast<Gtk::Box*>(target_elm->target_tag->tag_information.current_widget));
+    Gtk::Box* target_box = dynamic_cast<Gtk::Box*>(target_elm->target_tag->tag_information.current_widget);
+    if(!ContainerTagRenderer::syncVirtualizedChildren(target_elm->target_tag,
+        target_elm->target_tag->children.size() - 1, 0, 1) && target_box)
+        appended_elm->target_tag->render(target_box);
     
     interpreter->accessor->current_interp->refreshIdsAndClasses();
     
@@ -178,6 +191,8 @@ RunTimeVal* DocumentLib::popChild(COMPILED_FUNC_ARGS) {
     HtmlElementVal* target_elm = static_cast<HtmlElementVal*>(args[0]);
     target_elm->target_tag->children.back()->unRender();
     target_elm->target_tag->children.pop_back();
+    ContainerTagRenderer::syncVirtualizedChildren(target_elm->target_tag,
+        target_elm->target_tag->children.size(), 1, 0);
 
     interpreter->accessor->current_interp->refreshIdsAndClasses();
 
@@ -213,10 +228,8 @@ RunTimeVal* DocumentLib::connectEventHandler(COMPILED_FUNC_ARGS) {
 
     interpreter->garbageCollectionRestricter.registerEventHandler(handler);
 
-    EventPtr evt = event_table.at(event_name->str)(handler);
-    evt->bindEventToWidget(elm->target_tag->tag_information.current_widget,
-        interpreter);
-    
+    elm->target_tag->addEvent(event_table.at(event_name->str)(handler), interpreter);
+
     return nullptr;
 };
 RunTimeVal* DocumentLib::appendChildren(COMPILED_FUNC_ARGS) {
@@ -229,11 +242,17 @@ RunTimeVal* DocumentLib::appendChildren(COMPILED_FUNC_ARGS) {
     }
 
 
+    size_t first_new = target_parent->target_tag->children.size();
     target_parent->target_tag->children.insert(target_parent->target_tag->children.end(),
         actual_elms.begin(), actual_elms.end());
 
+    Gtk::Box* target_box = dynamic_cast<Gtk::Box*>(target_parent->target_tag->tag_information.current_widget);
+    if(ContainerTagRenderer::syncVirtualizedChildren(target_parent->target_tag, first_new, 0, actual_elms.size())
+        || !target_box)
+        return nullptr;
+
     for(auto& elm : actual_elms){
-        elm->render(dynamic_cast<Gtk::Box*>(target_parent->target_tag->tag_information.current_widget));
+        elm->render(target_box);
     }
 
     return nullptr;
@@ -242,12 +261,18 @@ RunTimeVal* DocumentLib::removeElement(COMPILED_FUNC_ARGS) {
     HtmlElementVal* target_parent = static_cast<HtmlElementVal*>(args[0]);
     HtmlElementVal* target_elm = static_cast<HtmlElementVal*>(args[1]);
 
-    target_parent->target_tag->children.erase(std::remove_if(target_parent->target_tag->children.begin(),
-       target_parent->target_tag->children.end(),
-        [&](std::shared_ptr<HTMLTag> current_tag){ return current_tag->tag_information.uuid == target_elm->target_tag->tag_information.uuid; }),
-            target_parent->target_tag->children.end());
+    auto& children = target_parent->target_tag->children;
+    auto itr = std::find_if(children.begin(), children.end(),
+        [&](const std::shared_ptr<HTMLTag>& current_tag){ return current_tag->tag_information.uuid == target_elm->target_tag->tag_information.uuid; });
 
+    // unrendered while the parent still owns it, erasing may free the tag
     target_elm->target_tag->unRender();
+    if(itr == children.end())
+        return nullptr;
+
+    size_t position = itr - children.begin();
+    children.erase(itr);
+    ContainerTagRenderer::syncVirtualizedChildren(target_parent->target_tag, position, 1, 0);
     return nullptr;
 };
 RunTimeVal* DocumentLib::clearChildren(COMPILED_FUNC_ARGS) {
@@ -255,7 +280,74 @@ RunTimeVal* DocumentLib::clearChildren(COMPILED_FUNC_ARGS) {
     for(auto& child : target_elm->target_tag->children){
         child->unRender();
     }
+    size_t removed = target_elm->target_tag->children.size();
     target_elm->target_tag->setChildren({});
+    ContainerTagRenderer::syncVirtualizedChildren(target_elm->target_tag, 0, removed, 0);
+
+    return nullptr;
+};
+void DocumentLib::replaceClasses(HTMLTag* target_tag, std::string new_classes, SigmaInterpreter* interpreter) {
+    // text tags carry their classes on their labels, not on their box ( see TextTagCssManager::propagateProps )
+    bool is_text_tag = txt_tags.contains(target_tag->tag_information.type);
+    Interpreter* interp = interpreter->accessor->current_interp;
+
+    auto swapClasses = [interp](HTMLTag* tag, const std::string& classes, bool swap_widget_classes){
+        Gtk::Widget* widget = swap_widget_classes ? tag->tag_information.current_widget : nullptr;
+        if(widget)
+            for(auto& css_class : tag->getStyleInputs().css_classes)
+                widget->remove_css_class(css_class);
+        interp->unindexClasses(tag);
+
+        tag->props["class"] = classes;
+        tag->invalidateStyleInputs();
+
+        interp->indexClasses(tag);
+        if(widget)
+            for(auto& css_class : tag->getStyleInputs().css_classes)
+                widget->add_css_class(css_class);
+    };
+
+    swapClasses(target_tag, new_classes, !is_text_tag);
+    if(is_text_tag)
+        for(auto& child : target_tag->children)
+            if(child->tag_information.type == String)
+                swapClasses(child.get(), new_classes, true);
+
+    interp->restyleTag(target_tag);
+};
+
+RunTimeVal* DocumentLib::setClass(COMPILED_FUNC_ARGS) {
+    HtmlElementVal* target_elm = static_cast<HtmlElementVal*>(args[0]);
+    replaceClasses(target_elm->target_tag, static_cast<StringVal*>(args[1])->str, interpreter);
+
+    return nullptr;
+};
+RunTimeVal* DocumentLib::addClass(COMPILED_FUNC_ARGS) {
+    HtmlElementVal* target_elm = static_cast<HtmlElementVal*>(args[0]);
+    const std::string& class_name = static_cast<StringVal*>(args[1])->str;
+
+    const auto& classes = target_elm->target_tag->getStyleInputs().css_classes;
+    if(std::find(classes.begin(), classes.end(), class_name) != classes.end())
+        return nullptr;
 
+    replaceClasses(target_elm->target_tag, target_elm->target_tag->props["class"] + " " + class_name, interpreter);
     return nullptr;
-};
\ No newline at end of file
+};
+RunTimeVal* DocumentLib::removeClass(COMPILED_FUNC_ARGS) {
+    HtmlElementVal* target_elm = static_cast<HtmlElementVal*>(args[0]);
+    const std::string& class_name = static_cast<StringVal*>(args[1])->str;
+
+    std::string new_classes;
+    bool removed = false;
+    for(auto& css_class : target_elm->target_tag->getStyleInputs().css_classes){
+        if(css_class == class_name){
+            removed = true;
+            continue;
+        }
+        new_classes += new_classes.empty() ? css_class : " " + css_class;
+    }
+
+    if(removed)
+        replaceClasses(target_elm->target_tag, std::move(new_classes), interpreter);
+    return nullptr;
+};
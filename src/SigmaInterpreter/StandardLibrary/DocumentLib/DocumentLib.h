@@ -34,6 +34,12 @@ public:
     static RunTimeVal* setOnClick(COMPILED_FUNC_ARGS);
     static RunTimeVal* connectEventHandler(COMPILED_FUNC_ARGS);
     static RunTimeVal* clearChildren(COMPILED_FUNC_ARGS);
+    static RunTimeVal* setClass(COMPILED_FUNC_ARGS);
+    static RunTimeVal* addClass(COMPILED_FUNC_ARGS);
+    static RunTimeVal* removeClass(COMPILED_FUNC_ARGS);
+
+    // swaps the gtk classes on the element ( and the labels of a text tag ) and restyles its subtree
+    static void replaceClasses(HTMLTag* target_tag, std::string new_classes, SigmaInterpreter* interpreter);
 
 
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "BinaryFile.h"
+#include "FileStreams.h"
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+// headers are written and read as they are in memory
+static_assert(std::endian::native == std::endian::little, "binary files are little endian");
+
+void BinaryFile::write(const std::string& path, const unsigned char* data, size_t size) {
+    BinaryFileHeader header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = current_version;
+    header.header_size = sizeof(BinaryFileHeader);
+    header.payload_offset = (sizeof(BinaryFileHeader) + payload_alignment - 1) / payload_alignment * payload_alignment;
+    header.payload_size = size;
+    header.payload_crc = checksum(data, size);
+    header.header_crc = checksum(reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+
+    std::string padding(header.payload_offset - sizeof(header), '\0');
+    // the old file may still be mapped ( data itself can be a view of it ), truncating it in place would
+    // pull the pages out from under the mapping. written next to it and renamed over, the mapping keeps the old inode
+    std::string tmp_path = path + ".tmp";
+    try {
+        FileWriter writer(tmp_path);
+        writer.write(std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+        writer.write(padding);
+        writer.write(std::string_view(reinterpret_cast<const char*>(data), size));
+        writer.close();
+    } catch(const std::runtime_error&) {
+        std::remove(tmp_path.c_str());
+        throw;
+    }
+    if(std::rename(tmp_path.c_str(), path.c_str()) != 0){
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("file " + path + " couldn't be replaced");
+    }
+};
+
+bool BinaryFile::isVersioned(std::string_view contents) {
+    return contents.size() >= sizeof(magic) && std::memcmp(contents.data(), magic, sizeof(magic)) == 0;
+};
+
+std::string_view BinaryFile::parse(const std::string& path, std::string_view contents, bool verify) {
+    if(contents.size() < sizeof(BinaryFileHeader) || !isVersioned(contents))
+        throw std::runtime_error("file " + path + " isn't a binary file");
+
+    BinaryFileHeader header;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if(header.version > current_version)
+        throw std::runtime_error("file " + path + " is binary format version " +
+            std::to_string(header.version) + ", newer than this build reads");
+
+    uint32_t header_crc = header.header_crc;
+    header.header_crc = 0;
+    if(checksum(reinterpret_cast<const unsigned char*>(&header), sizeof(header)) != header_crc)
+        throw std::runtime_error("file " + path + " has a corrupted header");
+
+    if(header.header_size < sizeof(BinaryFileHeader) || header.payload_offset < header.header_size ||
+        header.payload_offset > contents.size() || header.payload_size > contents.size() - header.payload_offset)
+        throw std::runtime_error("file " + path + " is truncated");
+
+    std::string_view payload = contents.substr(header.payload_offset, header.payload_size);
+    // the one pass over the payload, skipped by callers that trust the file
+    if(verify && checksum(reinterpret_cast<const unsigned char*>(payload.data()), payload.size()) != header.payload_crc)
+        throw std::runtime_error("file " + path + " has a corrupted payload");
+    return payload;
+};
+
+std::string_view BinaryFile::parseLegacy(const std::string& path, std::string_view contents) {
+    size_t siz = 0;
+    if(contents.size() < sizeof(size_t))
+        throw std::runtime_error("file " + path + " isn't a binary file");
+    std::memcpy(&siz, contents.data(), sizeof(size_t));
+    if(siz > contents.size() - sizeof(size_t))
+        throw std::runtime_error("file " + path + " is truncated");
+    return contents.substr(sizeof(size_t), siz);
+};
+
+uint32_t BinaryFile::checksum(const unsigned char* data, size_t size) {
+    return crc32_z(crc32_z(0, Z_NULL, 0), data, size);
+};
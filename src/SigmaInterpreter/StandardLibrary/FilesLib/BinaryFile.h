@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+//
+//  The On Disk Format Of writeBinaryFileSync. A Fixed 64 Byte Header ( Magic, Version, Sizes
+//  And Crc32s Of Both Header And Payload ) Followed By The Payload At A 64 Byte Aligned Offset,
+//  So A Mapped File Can Be Handed To Scripts As Is Without Copying The Payload Out Of It
+//
+
+struct BinaryFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t payload_offset;
+    uint64_t payload_size;
+    uint32_t payload_crc;
+    uint32_t flags;
+    // crc32 of the header with this field zeroed
+    uint32_t header_crc;
+    unsigned char reserved[20];
+};
+static_assert(sizeof(BinaryFileHeader) == 64, "the binary file header is 64 bytes on disk");
+
+class BinaryFile {
+public:
+    static constexpr char magic[8] = {'S', 'I', 'G', 'M', 'A', 'B', 'I', 'N'};
+    static constexpr uint32_t current_version = 1;
+    static constexpr size_t payload_alignment = 64;
+
+    // throws std::runtime_error if the file can't be written
+    static void write(const std::string& path, const unsigned char* data, size_t size);
+
+    // whether contents starts with the magic, files from before the format don't
+    static bool isVersioned(std::string_view contents);
+    // checks the header ( and the payload crc when verify is set ) and gives back the payload
+    // inside contents, throws std::runtime_error naming path if anything doesn't add up
+    static std::string_view parse(const std::string& path, std::string_view contents, bool verify = true);
+    // the old format, a native size_t length and then the bytes
+    static std::string_view parseLegacy(const std::string& path, std::string_view contents);
+
+    static uint32_t checksum(const unsigned char* data, size_t size);
+};
@@ -0,0 +1,143 @@
+#include "FileStreams.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+FileReader::FileReader(const std::string& path, size_t buffer_size): buffer(buffer_size) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        throw std::runtime_error("file " + path + " couldn't be opened for reading");
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+};
+
+FileReader::~FileReader() {
+    close();
+};
+
+bool FileReader::fill() {
+    if(buffer_pos < buffer_end)
+        return true;
+    if(reached_end || fd < 0)
+        return false;
+
+    ssize_t read_size;
+    do {
+        read_size = ::read(fd, buffer.data(), buffer.size());
+    } while(read_size < 0 && errno == EINTR);
+    if(read_size < 0)
+        throw std::runtime_error(std::string("file read failed, ") + std::strerror(errno));
+
+    buffer_pos = 0;
+    buffer_end = read_size;
+    reached_end = read_size == 0;
+    return read_size > 0;
+};
+
+bool FileReader::readLine(std::string& line) {
+    line.clear();
+    bool read_any = false;
+
+    while(fill()){
+        read_any = true;
+        const char* start = buffer.data() + buffer_pos;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', buffer_end - buffer_pos));
+        if(!newline){
+            // the line goes on past the buffer
+            line.append(start, buffer_end - buffer_pos);
+            buffer_pos = buffer_end;
+            continue;
+        }
+
+        line.append(start, newline - start);
+        buffer_pos += newline - start + 1;
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        return true;
+    }
+    return read_any;
+};
+
+bool FileReader::readChunk(size_t size, std::string& chunk) {
+    chunk.clear();
+    while(chunk.size() < size && fill()){
+        size_t take = std::min(size - chunk.size(), buffer_end - buffer_pos);
+        chunk.append(buffer.data() + buffer_pos, take);
+        buffer_pos += take;
+    }
+    return !chunk.empty();
+};
+
+void FileReader::close() {
+    if(fd < 0)
+        return;
+    ::close(fd);
+    fd = -1;
+    buffer_pos = buffer_end = 0;
+};
+
+FileWriter::FileWriter(const std::string& path, bool append, size_t buffer_size): buffer_capacity(buffer_size) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+    if(fd < 0)
+        throw std::runtime_error("file " + path + " couldn't be opened for writing");
+    buffer.reserve(buffer_capacity);
+};
+
+FileWriter::~FileWriter() {
+    try {
+        close();
+    } catch(const std::runtime_error&) {
+        // nobody is left to tell
+    }
+};
+
+void FileWriter::write(std::string_view data) {
+    if(fd < 0)
+        throw std::runtime_error("file writer is closed");
+
+    if(buffer.size() + data.size() <= buffer_capacity){
+        buffer.append(data);
+        return;
+    }
+    flush();
+    // bigger than the whole buffer, no point in copying it through
+    if(data.size() >= buffer_capacity)
+        writeAll(data);
+    else
+        buffer.append(data);
+};
+
+void FileWriter::flush() {
+    if(fd < 0 || buffer.empty())
+        return;
+    writeAll(buffer);
+    buffer.clear();
+};
+
+void FileWriter::writeAll(std::string_view data) {
+    while(!data.empty()){
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if(written < 0 && errno == EINTR)
+            continue;
+        if(written < 0)
+            throw std::runtime_error(std::string("file write failed, ") + std::strerror(errno));
+        data.remove_prefix(written);
+    }
+};
+
+void FileWriter::close() {
+    if(fd < 0)
+        return;
+    int closing_fd = fd;
+    try {
+        flush();
+    } catch(const std::runtime_error&) {
+        ::close(closing_fd);
+        fd = -1;
+        throw;
+    }
+    ::close(closing_fd);
+    fd = -1;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// a file read front to back through one fixed buffer, however big the file is
+// only the buffer and what the caller takes out of it are ever in memory
+class FileReader {
+public:
+    // throws std::runtime_error if the file can't be opened
+    explicit FileReader(const std::string& path, size_t buffer_size = 64 * 1024);
+    ~FileReader();
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    // the next line without its \n ( or \r\n ), false at the end of the file
+    bool readLine(std::string& line);
+    // up to size bytes, less only at the end of the file, false once there's nothing left
+    bool readChunk(size_t size, std::string& chunk);
+
+    bool isOpen() const { return fd >= 0; };
+    void close();
+
+private:
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t buffer_pos = 0;
+    size_t buffer_end = 0;
+    bool reached_end = false;
+
+    // refills the buffer once it's used up, false at the end of the file
+    bool fill();
+};
+
+// writes collect in a buffer and go out to the file when it fills, on flush and on close
+class FileWriter {
+public:
+    explicit FileWriter(const std::string& path, bool append = false, size_t buffer_size = 64 * 1024);
+    // closes, so nothing written is lost when a handle is collected without being closed
+    ~FileWriter();
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    void write(std::string_view data);
+    void flush();
+
+    bool isOpen() const { return fd >= 0; };
+    void close();
+
+private:
+    int fd = -1;
+    std::string buffer;
+    size_t buffer_capacity;
+
+    void writeAll(std::string_view data);
+};
@@ -1,6 +1,12 @@
 #include "FilesLib.h"
+#include "BinaryFile.h"
+#include "FileStreams.h"
+#include "MappedFile.h"
 #include <boost/asio/post.hpp>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <unordered_map>
 #include "../../../Concurrency/ThreadPool.h"
@@ -11,12 +17,15 @@ ObjectVal* FilesLib::getStruct() {
     std::unordered_map<std::string, RunTimeValue> vals = {
         {"readFileSync", RunTimeFactory::makeNativeFunction(&FilesLib::readFileSync, {{"file_path", StringType}})},
         {"writeFileSync", RunTimeFactory::makeNativeFunction(&FilesLib::writeFileSync, {{"file_path", StringType}, {"string", StringType}})},
-        {"readBinaryFileSync", RunTimeFactory::makeNativeFunction(&FilesLib::readBinaryFileSync, {{"file_name", StringType}})},
+        {"readBinaryFileSync", RunTimeFactory::makeNativeFunction(&FilesLib::readBinaryFileSync, {{"file_name", StringType}, {"verify", BoolType, true}})},
         {"writeBinaryFileSync", RunTimeFactory::makeNativeFunction(&FilesLib::writeBinaryFileSync, {{"file_name", StringType}, {"binary", BinaryType}})},
         {"readFileAsync", RunTimeFactory::makeNativeFunction(&FilesLib::readFileAsync, {{"file_name", StringType}, {"handler", LambdaType}})},
         {"writeFileAsync", RunTimeFactory::makeNativeFunction(&FilesLib::writeFileAsync, {{"file_name", StringType}, {"string", StringType}, {"handler", LambdaType}})},
         {"readBinaryFileAsync", RunTimeFactory::makeNativeFunction(&FilesLib::readBinaryFileAsync, {{"file_name", StringType}, {"handler", LambdaType}})},
-        {"writeBinaryFileAsync", RunTimeFactory::makeNativeFunction(&FilesLib::writeBinaryFileAsync, {{"file_name", StringType}, {"binary", BinaryType}, {"handler", LambdaType}})}
+        {"writeBinaryFileAsync", RunTimeFactory::makeNativeFunction(&FilesLib::writeBinaryFileAsync, {{"file_name", StringType}, {"binary", BinaryType}, {"handler", LambdaType}})},
+        {"mapFile", RunTimeFactory::makeNativeFunction(&FilesLib::mapFile, {{"file_path", StringType}})},
+        {"openReader", RunTimeFactory::makeNativeFunction(&FilesLib::openReader, {{"file_path", StringType}})},
+        {"openWriter", RunTimeFactory::makeNativeFunction(&FilesLib::openWriter, {{"file_path", StringType}, {"append", BoolType, true}})}
     };
 
     return RunTimeFactory::makeStruct(std::move(vals));
@@ -31,14 +40,9 @@ RunTimeValue FilesLib::readFileSync(COMPILED_FUNC_ARGS) {
     std::string path = static_cast<StringVal*>(args[0])->str;
     if(!std::filesystem::exists(path)) 
         throw std::runtime_error("file " + path + " doesn't exist");
-    std::ifstream strea(path, std::ios::ate);
-    size_t s = strea.tellg();
-    std::string strr;
-    strr.resize(s);
-    strea.seekg(0, std::ios::beg);
-    strea.read(&strr[0], s);
-    strea.close();
-    return  StringWrapper::genObject(RunTimeFactory::makeString(std::move(strr)));
+    // straight from the page cache into the string, one copy
+    MappedFile file(path);
+    return  StringWrapper::genObject(RunTimeFactory::makeString(std::string(file.view())));
 };
 RunTimeValue FilesLib::writeFileSync(COMPILED_FUNC_ARGS) {
     if(!interpreter->perms.isPermissionGranted(FileWriting) && 
@@ -59,12 +63,8 @@ RunTimeValue FilesLib::writeBinaryFileSync(COMPILED_FUNC_ARGS){
         !interpreter->perms.isPermissionGranted(FileFullAccess))
         throw std::runtime_error("Permission \'FileWriting\' Not Granted!");
     std::string path = static_cast<StringVal*>(args[0])->str;
-    std::vector<unsigned char> val = static_cast<BinaryVal*>(args[1])->binary_data;
-    std::ofstream strea(path, std::ios::binary);
-    size_t siz = val.size();
-    strea.write(reinterpret_cast<const char*>(&siz), sizeof(size_t));
-    strea.write(reinterpret_cast<const char*>(&val[0]), val.size());
-    strea.close();
+    auto val = static_cast<BinaryVal*>(args[1]);
+    BinaryFile::write(path, val->data(), val->size());
     return RunTimeFactory::makeNum(0); // success
 };
 RunTimeValue FilesLib::readBinaryFileSync(COMPILED_FUNC_ARGS){
@@ -72,14 +72,22 @@ RunTimeValue FilesLib::readBinaryFileSync(COMPILED_FUNC_ARGS){
         !interpreter->perms.isPermissionGranted(FileFullAccess))
         throw std::runtime_error("Permission \'FileReading\' Not Granted!");
     std::string path = static_cast<StringVal*>(args[0])->str;
-    std::vector<unsigned char> val;
-    size_t siz = 0;
-    std::ifstream strea(path, std::ios::binary);
-    strea.read(reinterpret_cast<char*>(&siz), sizeof(size_t));
-    val.resize(siz);
-    strea.read(reinterpret_cast<char*>(&val[0]), siz);
-    strea.close();
-    return RunTimeFactory::makeBinary(val);
+    // readBinaryFileAsync passes its handler where verify would be
+    bool verify = args.size() < 2 || args[1]->type != BoolType || static_cast<BoolVal*>(args[1])->boolean;
+    auto file = std::make_shared<MappedFile>(path);
+    std::string_view contents = file->view();
+
+    // files from before the format are copied out, the mapping can't be shared with them
+    if(!BinaryFile::isVersioned(contents)){
+        std::string_view payload = BinaryFile::parseLegacy(path, contents);
+        auto body = reinterpret_cast<const unsigned char*>(payload.data());
+        return RunTimeFactory::makeBinary(std::vector<unsigned char>(body, body + payload.size()));
+    }
+
+    // the value reads straight out of the mapping and keeps it open
+    std::string_view payload = BinaryFile::parse(path, contents, verify);
+    return RunTimeFactory::makeBinaryView(file,
+        reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
 };
 
 
@@ -124,4 +132,146 @@ RunTimeValue FilesLib::readBinaryFileAsync(COMPILED_FUNC_ARGS) {
         interpreter->garbageCollectionRestricter.unRegisterAsyncLambda(lambda_val->lambda_uuid);
     });
     return nullptr;
-};
\ No newline at end of file
+};
+
+RunTimeValue FilesLib::mapFile(COMPILED_FUNC_ARGS) {
+    if(!interpreter->perms.isPermissionGranted(FileReading) && 
+        !interpreter->perms.isPermissionGranted(FileFullAccess))
+        throw std::runtime_error("Permission \'FileReading\' Not Granted!");
+    std::string path = static_cast<StringVal*>(args[0])->str;
+    if(!std::filesystem::exists(path)) 
+        throw std::runtime_error("file " + path + " doesn't exist");
+
+    return makeFileView(std::make_shared<MappedFile>(path));
+};
+
+namespace {
+
+// NaN, the infinities and negatives are refused, anything past limit is clamped to it before the cast
+bool toClampedSize(double num, size_t limit, size_t& out) {
+    if(!std::isfinite(num) || num < 0)
+        return false;
+    out = num >= static_cast<double>(limit) ? limit : static_cast<size_t>(num);
+    return true;
+};
+
+}
+
+ObjectVal* FilesLib::makeFileView(std::shared_ptr<MappedFile> file) {
+    // the functions share the mapping, it's unmapped on close or once they're all collected
+    auto checkOpen = [](MappedFile& target){
+        if(!target.isOpen())
+            throw std::runtime_error("file view is closed");
+    };
+
+    std::unordered_map<std::string, RunTimeValue> vals = {
+        {"size", RunTimeFactory::makeNativeFunction([file, checkOpen](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            checkOpen(*file);
+            return RunTimeFactory::makeNum(file->size());
+        }, {})},
+        // copies out just the bytes asked for, clamped to the end of the file
+        {"slice", RunTimeFactory::makeNativeFunction([file, checkOpen](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            checkOpen(*file);
+            std::string_view contents = file->view();
+            size_t start, size;
+            if(!toClampedSize(static_cast<NumVal*>(args[0])->num, contents.size(), start) ||
+                !toClampedSize(static_cast<NumVal*>(args[1])->num, contents.size(), size))
+                throw std::runtime_error("slice Excepts a positive finite offset and size");
+
+            return StringWrapper::genObject(RunTimeFactory::makeString(
+                std::string(contents.substr(start, size))));
+        }, {{"offset", NumType}, {"size", NumType}})},
+        {"indexOf", RunTimeFactory::makeNativeFunction([file, checkOpen](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            checkOpen(*file);
+            const std::string& target = static_cast<StringVal*>(args[0])->str;
+            std::string_view contents = file->view();
+            size_t from = 0;
+            if(args.size() > 1){
+                // negative starts from the beginning like js, NaN is still refused below
+                double from_num = static_cast<NumVal*>(args[1])->num;
+                if(from_num < 0) from_num = 0;
+                if(!toClampedSize(from_num, contents.size(), from))
+                    throw std::runtime_error("indexOf Excepts arg 1 to be a finite number");
+            }
+
+            size_t index = contents.find(target, from);
+            return RunTimeFactory::makeNum(index == std::string_view::npos ? -1 : static_cast<double>(index));
+        }, {{"str", StringType}, {"from", NumType, true}})},
+        {"close", RunTimeFactory::makeNativeFunction([file](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            file->close();
+            return nullptr;
+        }, {})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+RunTimeValue FilesLib::openReader(COMPILED_FUNC_ARGS) {
+    if(!interpreter->perms.isPermissionGranted(FileReading) && 
+        !interpreter->perms.isPermissionGranted(FileFullAccess))
+        throw std::runtime_error("Permission \'FileReading\' Not Granted!");
+    std::string path = static_cast<StringVal*>(args[0])->str;
+    if(!std::filesystem::exists(path)) 
+        throw std::runtime_error("file " + path + " doesn't exist");
+
+    auto reader = std::make_shared<FileReader>(path);
+    auto checkOpen = [](FileReader& target){
+        if(!target.isOpen())
+            throw std::runtime_error("file reader is closed");
+    };
+
+    // null once the file is exhausted
+    std::unordered_map<std::string, RunTimeValue> vals = {
+        {"readLine", RunTimeFactory::makeNativeFunction([reader, checkOpen](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            checkOpen(*reader);
+            std::string line;
+            if(!reader->readLine(line))
+                return RunTimeFactory::makeVal<NullVal>();
+            return StringWrapper::genObject(RunTimeFactory::makeString(std::move(line)));
+        }, {})},
+        {"readChunk", RunTimeFactory::makeNativeFunction([reader, checkOpen](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            checkOpen(*reader);
+            size_t size;
+            if(!toClampedSize(static_cast<NumVal*>(args[0])->num, std::string().max_size(), size) || size < 1)
+                throw std::runtime_error("readChunk Excepts arg 0 to be a finite number of at least 1");
+
+            std::string chunk;
+            if(!reader->readChunk(size, chunk))
+                return RunTimeFactory::makeVal<NullVal>();
+            return StringWrapper::genObject(RunTimeFactory::makeString(std::move(chunk)));
+        }, {{"size", NumType}})},
+        {"close", RunTimeFactory::makeNativeFunction([reader](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            reader->close();
+            return nullptr;
+        }, {})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+RunTimeValue FilesLib::openWriter(COMPILED_FUNC_ARGS) {
+    if(!interpreter->perms.isPermissionGranted(FileWriting) && 
+        !interpreter->perms.isPermissionGranted(FileFullAccess))
+        throw std::runtime_error("Permission \'FileWriting\' Not Granted!");
+    std::string path = static_cast<StringVal*>(args[0])->str;
+    bool append = args.size() > 1 && static_cast<BoolVal*>(args[1])->boolean;
+
+    auto writer = std::make_shared<FileWriter>(path, append);
+    std::unordered_map<std::string, RunTimeValue> vals = {
+        {"write", RunTimeFactory::makeNativeFunction([writer](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            writer->write(static_cast<StringVal*>(args[0])->str);
+            return nullptr;
+        }, {{"string", StringType}})},
+        {"flush", RunTimeFactory::makeNativeFunction([writer](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            writer->flush();
+            return nullptr;
+        }, {})},
+        // a writer that's never closed is flushed and closed when the gc collects it
+        {"close", RunTimeFactory::makeNativeFunction([writer](COMPILED_FUNC_ARGS) -> RunTimeValue {
+            writer->close();
+            return nullptr;
+        }, {})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
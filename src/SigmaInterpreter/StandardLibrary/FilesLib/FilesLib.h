@@ -1,5 +1,8 @@
 #pragma once
 #include "../StdLib.h"
+#include <memory>
+
+class MappedFile;
 
 class FilesLib : public StdLib {
 public:
@@ -13,4 +16,15 @@ public:
     static RunTimeValue writeFileAsync(std::vector<RunTimeValue>& args, SigmaInterpreter*);
     static RunTimeValue writeBinaryFileAsync(std::vector<RunTimeValue>& args, SigmaInterpreter*);
     static RunTimeValue readBinaryFileAsync(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+
+    // a read only view of the file ( size, slice, indexOf, close ) that's mapped rather than read,
+    // so a huge file costs nothing until pieces of it are sliced out
+    static RunTimeValue mapFile(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    // handles that go through the file a buffer at a time, readLine / readChunk / close and
+    // write / flush / close. closed by the gc if the script never closes them
+    static RunTimeValue openReader(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    static RunTimeValue openWriter(std::vector<RunTimeValue>& args, SigmaInterpreter*);
+
+private:
+    static ObjectVal* makeFileView(std::shared_ptr<MappedFile> file);
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        throw std::runtime_error("file " + path + " couldn't be opened");
+
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)){
+        ::close(fd);
+        throw std::runtime_error("file " + path + " isn't a regular file");
+    }
+
+    // mmap refuses a zero length, an empty file is just an empty view
+    mapped_size = file_stat.st_size;
+    if(mapped_size > 0){
+        void* mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED){
+            ::close(fd);
+            throw std::runtime_error("file " + path + " couldn't be mapped");
+        }
+        // scripts mostly walk files front to back, let the kernel read ahead
+        madvise(mapping, mapped_size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+    }
+    // the mapping keeps the file alive on its own
+    ::close(fd);
+};
+
+MappedFile::~MappedFile() {
+    close();
+};
+
+void MappedFile::close() {
+    if(!open)
+        return;
+    if(data)
+        munmap(const_cast<char*>(data), mapped_size);
+    data = nullptr;
+    mapped_size = 0;
+    open = false;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// a file mapped read only into memory, the kernel pages it in as it's touched so opening
+// even a huge file costs nothing up front and nothing is copied until someone asks for a piece
+class MappedFile {
+public:
+    // throws std::runtime_error if the file can't be opened or mapped
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const { return std::string_view(data, mapped_size); };
+    size_t size() const { return mapped_size; };
+    bool isOpen() const { return open; };
+    void close();
+
+private:
+    const char* data = nullptr;
+    size_t mapped_size = 0;
+    bool open = true;
+};
@@ -0,0 +1,246 @@
+#include "MathKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MATH_KERNELS_X86
+#endif
+
+namespace {
+
+struct KernelTable {
+    void (*add)(const double*, const double*, double*, size_t);
+    void (*mul)(const double*, const double*, double*, size_t);
+    void (*fma)(const double*, const double*, const double*, double*, size_t);
+    void (*sqrt)(const double*, double*, size_t);
+    double (*sum)(const double*, size_t);
+    double (*min)(const double*, size_t);
+    double (*max)(const double*, size_t);
+    double (*dot)(const double*, const double*, size_t);
+    const char* instruction_set;
+};
+
+// scalar, also finishes off the tail the vector loops leave behind
+
+void addScalar(const double* a, const double* b, double* out, size_t n) {
+    for(size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+}
+void mulScalar(const double* a, const double* b, double* out, size_t n) {
+    for(size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+}
+void fmaScalar(const double* a, const double* b, const double* c, double* out, size_t n) {
+    for(size_t i = 0; i < n; i++) out[i] = std::fma(a[i], b[i], c[i]);
+}
+void sqrtScalar(const double* a, double* out, size_t n) {
+    for(size_t i = 0; i < n; i++) out[i] = std::sqrt(a[i]);
+}
+double sumScalar(const double* a, size_t n) {
+    double total = 0;
+    for(size_t i = 0; i < n; i++) total += a[i];
+    return total;
+}
+double minScalar(const double* a, size_t n) {
+    double result = std::numeric_limits<double>::infinity();
+    for(size_t i = 0; i < n; i++) result = std::min(result, a[i]);
+    return result;
+}
+double maxScalar(const double* a, size_t n) {
+    double result = -std::numeric_limits<double>::infinity();
+    for(size_t i = 0; i < n; i++) result = std::max(result, a[i]);
+    return result;
+}
+double dotScalar(const double* a, const double* b, size_t n) {
+    double total = 0;
+    for(size_t i = 0; i < n; i++) total += a[i] * b[i];
+    return total;
+}
+
+#ifdef MATH_KERNELS_X86
+
+// sse2, two doubles at a time. every x86-64 cpu has it
+
+__attribute__((target("sse2"))) void addSse2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    addScalar(a + i, b + i, out + i, n - i);
+}
+__attribute__((target("sse2"))) void mulSse2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    mulScalar(a + i, b + i, out + i, n - i);
+}
+__attribute__((target("sse2"))) void sqrtSse2(const double* a, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(a + i)));
+    sqrtScalar(a + i, out + i, n - i);
+}
+__attribute__((target("sse2"))) double horizontalSum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+__attribute__((target("sse2"))) double sumSse2(const double* a, size_t n) {
+    // two accumulators so each add doesn't wait on the one before it
+    __m128d total0 = _mm_setzero_pd(), total1 = _mm_setzero_pd();
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        total0 = _mm_add_pd(total0, _mm_loadu_pd(a + i));
+        total1 = _mm_add_pd(total1, _mm_loadu_pd(a + i + 2));
+    }
+    return horizontalSum(_mm_add_pd(total0, total1)) + sumScalar(a + i, n - i);
+}
+// the loaded values go first, so a NaN loses to what's already there the same as in std::min
+__attribute__((target("sse2"))) double minSse2(const double* a, size_t n) {
+    __m128d result = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2)
+        result = _mm_min_pd(_mm_loadu_pd(a + i), result);
+    double lanes[2];
+    _mm_storeu_pd(lanes, result);
+    return std::min({lanes[0], lanes[1], minScalar(a + i, n - i)});
+}
+__attribute__((target("sse2"))) double maxSse2(const double* a, size_t n) {
+    __m128d result = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2)
+        result = _mm_max_pd(_mm_loadu_pd(a + i), result);
+    double lanes[2];
+    _mm_storeu_pd(lanes, result);
+    return std::max({lanes[0], lanes[1], maxScalar(a + i, n - i)});
+}
+__attribute__((target("sse2"))) double dotSse2(const double* a, const double* b, size_t n) {
+    __m128d total0 = _mm_setzero_pd(), total1 = _mm_setzero_pd();
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        total0 = _mm_add_pd(total0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        total1 = _mm_add_pd(total1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    return horizontalSum(_mm_add_pd(total0, total1)) + dotScalar(a + i, b + i, n - i);
+}
+
+// avx2 with fma, four doubles at a time
+
+__attribute__((target("avx2,fma"))) void addAvx2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    addScalar(a + i, b + i, out + i, n - i);
+}
+__attribute__((target("avx2,fma"))) void mulAvx2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    mulScalar(a + i, b + i, out + i, n - i);
+}
+__attribute__((target("avx2,fma"))) void fmaAvx2(const double* a, const double* b, const double* c, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _mm256_loadu_pd(c + i)));
+    fmaScalar(a + i, b + i, c + i, out + i, n - i);
+}
+__attribute__((target("avx2,fma"))) void sqrtAvx2(const double* a, double* out, size_t n) {
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(a + i)));
+    sqrtScalar(a + i, out + i, n - i);
+}
+__attribute__((target("avx2,fma"))) double horizontalSum(__m256d v) {
+    __m128d halves = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(halves, _mm_unpackhi_pd(halves, halves)));
+}
+__attribute__((target("avx2,fma"))) double sumAvx2(const double* a, size_t n) {
+    __m256d total0 = _mm256_setzero_pd(), total1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        total0 = _mm256_add_pd(total0, _mm256_loadu_pd(a + i));
+        total1 = _mm256_add_pd(total1, _mm256_loadu_pd(a + i + 4));
+    }
+    return horizontalSum(_mm256_add_pd(total0, total1)) + sumScalar(a + i, n - i);
+}
+__attribute__((target("avx2,fma"))) double minAvx2(const double* a, size_t n) {
+    __m256d result = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        result = _mm256_min_pd(_mm256_loadu_pd(a + i), result);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, result);
+    return std::min({lanes[0], lanes[1], lanes[2], lanes[3], minScalar(a + i, n - i)});
+}
+__attribute__((target("avx2,fma"))) double maxAvx2(const double* a, size_t n) {
+    __m256d result = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        result = _mm256_max_pd(_mm256_loadu_pd(a + i), result);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, result);
+    return std::max({lanes[0], lanes[1], lanes[2], lanes[3], maxScalar(a + i, n - i)});
+}
+__attribute__((target("avx2,fma"))) double dotAvx2(const double* a, const double* b, size_t n) {
+    __m256d total0 = _mm256_setzero_pd(), total1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        total0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), total0);
+        total1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), total1);
+    }
+    return horizontalSum(_mm256_add_pd(total0, total1)) + dotScalar(a + i, b + i, n - i);
+}
+
+#endif
+
+KernelTable pickKernels() {
+#ifdef MATH_KERNELS_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return {addAvx2, mulAvx2, fmaAvx2, sqrtAvx2, sumAvx2, minAvx2, maxAvx2, dotAvx2, "avx2"};
+    if(__builtin_cpu_supports("sse2"))
+        // sse2 has no fused multiply add, std::fma keeps the single rounding the other paths give
+        return {addSse2, mulSse2, fmaScalar, sqrtSse2, sumSse2, minSse2, maxSse2, dotSse2, "sse2"};
+#endif
+    return {addScalar, mulScalar, fmaScalar, sqrtScalar, sumScalar, minScalar, maxScalar, dotScalar, "scalar"};
+}
+
+const KernelTable& getKernels() {
+    static const KernelTable kernels = pickKernels();
+    return kernels;
+}
+
+}
+
+void MathKernels::add(const double* a, const double* b, double* out, size_t n) {
+    getKernels().add(a, b, out, n);
+};
+void MathKernels::mul(const double* a, const double* b, double* out, size_t n) {
+    getKernels().mul(a, b, out, n);
+};
+void MathKernels::fma(const double* a, const double* b, const double* c, double* out, size_t n) {
+    getKernels().fma(a, b, c, out, n);
+};
+void MathKernels::sqrt(const double* a, double* out, size_t n) {
+    getKernels().sqrt(a, out, n);
+};
+void MathKernels::exp(const double* a, double* out, size_t n) {
+    for(size_t i = 0; i < n; i++) out[i] = std::exp(a[i]);
+};
+void MathKernels::log(const double* a, double* out, size_t n) {
+    for(size_t i = 0; i < n; i++) out[i] = std::log(a[i]);
+};
+
+double MathKernels::sum(const double* a, size_t n) {
+    return getKernels().sum(a, n);
+};
+double MathKernels::min(const double* a, size_t n) {
+    return getKernels().min(a, n);
+};
+double MathKernels::max(const double* a, size_t n) {
+    return getKernels().max(a, n);
+};
+double MathKernels::dot(const double* a, const double* b, size_t n) {
+    return getKernels().dot(a, b, n);
+};
+
+const char* MathKernels::getInstructionSet() {
+    return getKernels().instruction_set;
+};
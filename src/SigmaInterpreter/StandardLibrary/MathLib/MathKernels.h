@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+//
+//  Bulk Math Over Arrays Of Doubles. Each Kernel Has A Scalar, An Sse2 And An Avx2 Version,
+//  The Best One The Cpu Supports Is Picked The First Time Any Of Them Runs
+//
+
+// out may be the same buffer as an input, every length is n
+class MathKernels {
+public:
+    static void add(const double* a, const double* b, double* out, size_t n);
+    static void mul(const double* a, const double* b, double* out, size_t n);
+    // a * b + c, rounded once on every path
+    static void fma(const double* a, const double* b, const double* c, double* out, size_t n);
+    static void sqrt(const double* a, double* out, size_t n);
+    // exp and log have no vector instruction, these stay scalar libm loops
+    static void exp(const double* a, double* out, size_t n);
+    static void log(const double* a, double* out, size_t n);
+
+    static double sum(const double* a, size_t n);
+    // +infinity / -infinity for an empty span, like js
+    static double min(const double* a, size_t n);
+    static double max(const double* a, size_t n);
+    static double dot(const double* a, const double* b, size_t n);
+
+    // "avx2", "sse2" or "scalar"
+    static const char* getInstructionSet();
+};
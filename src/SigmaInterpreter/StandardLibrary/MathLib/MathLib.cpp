@@ -1,23 +1,91 @@
 #include "MathLib.h"
+#include "MathKernels.h"
+#include "../TypeWrappers/TypedArrayWrapper.h"
+#include <cmath>
 #include <stdexcept>
 #include <unordered_map>
 
 RunTimeVal* MathLib::getStruct(){
     std::unordered_map<std::string, RunTimeVal*> func_map = {
-        {"sqrt", RunTimeFactory::makeNativeFunction(&MathLib::mathSqrt, {{"number", NumType}})},
+        {"sqrt", RunTimeFactory::makeNativeFunction(&MathLib::mathSqrt, {{"number", AnyType}})},
+        {"exp", RunTimeFactory::makeNativeFunction(&MathLib::mathExp, {{"number", AnyType}})},
+        {"log", RunTimeFactory::makeNativeFunction(&MathLib::mathLog, {{"number", AnyType}})},
         {"pow", RunTimeFactory::makeNativeFunction(&MathLib::mathPow, {{"number", NumType}, {"exponent", NumType}})},
         {"rand", RunTimeFactory::makeNativeFunction(&MathLib::mathRand, {})},
+        {"add", RunTimeFactory::makeNativeFunction(&MathLib::mathAdd, {{"a", AnyType}, {"b", AnyType}})},
+        {"mul", RunTimeFactory::makeNativeFunction(&MathLib::mathMul, {{"a", AnyType}, {"b", AnyType}})},
+        {"fma", RunTimeFactory::makeNativeFunction(&MathLib::mathFma, {{"a", AnyType}, {"b", AnyType}, {"c", AnyType}})},
+        {"sum", RunTimeFactory::makeNativeFunction(&MathLib::mathSum, {{"array", AnyType}})},
+        {"min", RunTimeFactory::makeNativeFunction(&MathLib::mathMin, {{"array", AnyType}})},
+        {"max", RunTimeFactory::makeNativeFunction(&MathLib::mathMax, {{"array", AnyType}})},
+        {"dot", RunTimeFactory::makeNativeFunction(&MathLib::mathDot, {{"a", AnyType}, {"b", AnyType}})},
         {"PI", RunTimeFactory::makeNum(M_PI)}
     };
 
     return RunTimeFactory::makeStruct(std::move(func_map));
 };
 
+std::span<const double> MathLib::getSpan(RunTimeVal* val, std::vector<double>& scratch, const std::string& func_name) {
+    if(val->type == TypedArrayType){
+        auto typed_array = static_cast<TypedArrayVal*>(val);
+        if(typed_array->kind == TypedArrayVal::Float64Elements)
+            return typed_array->floats;
+        scratch.assign(typed_array->ints.begin(), typed_array->ints.end());
+        return scratch;
+    }
+    if(val->type == ArrayType){
+        auto array = static_cast<ArrayVal*>(val);
+        scratch.resize(array->vals.size());
+        for(size_t i = 0; i < array->vals.size(); i++){
+            if(!array->vals[i] || array->vals[i]->type != NumType)
+                throw std::runtime_error(func_name + " excepts an array of numbers, element " +
+                    std::to_string(i) + " isn't one");
+            scratch[i] = static_cast<NumVal*>(array->vals[i])->num;
+        }
+        return scratch;
+    }
+    throw std::runtime_error(func_name + " excepts an array or a typed array");
+};
+
+TypedArrayVal* MathLib::makeResult(size_t size) {
+    return RunTimeFactory::makeTypedArray(TypedArrayVal::Float64Elements, size);
+};
+
+void MathLib::checkSameLength(std::span<const double> a, std::span<const double> b, const std::string& func_name) {
+    if(a.size() != b.size())
+        throw std::runtime_error(func_name + " excepts arrays of the same length, got " +
+            std::to_string(a.size()) + " and " + std::to_string(b.size()));
+};
+
 RunTimeVal* MathLib::mathSqrt(COMPILED_FUNC_ARGS) {
-    if(args[0]->type != NumType)
-        throw std::runtime_error("sqrt excepts args 0 to be a number");
+    if(args[0]->type == NumType)
+        return RunTimeFactory::makeNum(sqrt(static_cast<NumVal*>(args[0])->num));
+
+    std::vector<double> scratch;
+    auto a = getSpan(args[0], scratch, "sqrt");
+    TypedArrayVal* result = makeResult(a.size());
+    MathKernels::sqrt(a.data(), result->floats.data(), a.size());
+    return TypedArrayWrapper::genObject(result);
+};
+RunTimeVal* MathLib::mathExp(COMPILED_FUNC_ARGS) {
+    if(args[0]->type == NumType)
+        return RunTimeFactory::makeNum(exp(static_cast<NumVal*>(args[0])->num));
 
-    return RunTimeFactory::makeNum(sqrt(static_cast<NumVal*>(args[0])->num));
+    std::vector<double> scratch;
+    auto a = getSpan(args[0], scratch, "exp");
+    TypedArrayVal* result = makeResult(a.size());
+    MathKernels::exp(a.data(), result->floats.data(), a.size());
+    return TypedArrayWrapper::genObject(result);
+};
+RunTimeVal* MathLib::mathLog(COMPILED_FUNC_ARGS) {
+    if(args[0]->type == NumType)
+        return RunTimeFactory::makeNum(log(static_cast<NumVal*>(args[0])->num));
+
+    std::vector<double> scratch;
+    auto a = getSpan(args[0], scratch, "log");
+    TypedArrayVal* result = makeResult(a.size());
+    MathKernels::log(a.data(), result->floats.data(), a.size());
+    return TypedArrayWrapper::genObject(result);
 };
 RunTimeVal* MathLib::mathPow(COMPILED_FUNC_ARGS) {
     if(args[0]->type != NumType)
@@ -28,4 +96,60 @@ RunTimeVal* MathLib::mathPow(COMPILED_FUNC_ARGS) {
 };
 RunTimeVal* MathLib::mathRand(COMPILED_FUNC_ARGS) {
     return RunTimeFactory::makeNum(rand());
-};
\ No newline at end of file
+};
+
+RunTimeVal* MathLib::mathAdd(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch_a, scratch_b;
+    auto a = getSpan(args[0], scratch_a, "add");
+    auto b = getSpan(args[1], scratch_b, "add");
+    checkSameLength(a, b, "add");
+
+    TypedArrayVal* result = makeResult(a.size());
+    MathKernels::add(a.data(), b.data(), result->floats.data(), a.size());
+    return TypedArrayWrapper::genObject(result);
+};
+RunTimeVal* MathLib::mathMul(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch_a, scratch_b;
+    auto a = getSpan(args[0], scratch_a, "mul");
+    auto b = getSpan(args[1], scratch_b, "mul");
+    checkSameLength(a, b, "mul");
+
+    TypedArrayVal* result = makeResult(a.size());
+    MathKernels::mul(a.data(), b.data(), result->floats.data(), a.size());
+    return TypedArrayWrapper::genObject(result);
+};
+RunTimeVal* MathLib::mathFma(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch_a, scratch_b, scratch_c;
+    auto a = getSpan(args[0], scratch_a, "fma");
+    auto b = getSpan(args[1], scratch_b, "fma");
+    auto c = getSpan(args[2], scratch_c, "fma");
+    checkSameLength(a, b, "fma");
+    checkSameLength(a, c, "fma");
+
+    TypedArrayVal* result = makeResult(a.size());
+    MathKernels::fma(a.data(), b.data(), c.data(), result->floats.data(), a.size());
+    return TypedArrayWrapper::genObject(result);
+};
+
+RunTimeVal* MathLib::mathSum(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch;
+    auto a = getSpan(args[0], scratch, "sum");
+    return RunTimeFactory::makeNum(MathKernels::sum(a.data(), a.size()));
+};
+RunTimeVal* MathLib::mathMin(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch;
+    auto a = getSpan(args[0], scratch, "min");
+    return RunTimeFactory::makeNum(MathKernels::min(a.data(), a.size()));
+};
+RunTimeVal* MathLib::mathMax(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch;
+    auto a = getSpan(args[0], scratch, "max");
+    return RunTimeFactory::makeNum(MathKernels::max(a.data(), a.size()));
+};
+RunTimeVal* MathLib::mathDot(COMPILED_FUNC_ARGS) {
+    std::vector<double> scratch_a, scratch_b;
+    auto a = getSpan(args[0], scratch_a, "dot");
+    auto b = getSpan(args[1], scratch_b, "dot");
+    checkSameLength(a, b, "dot");
+    return RunTimeFactory::makeNum(MathKernels::dot(a.data(), b.data(), a.size()));
+};
@@ -1,11 +1,31 @@
 #pragma once
 #include "../StdLib.h"
+#include <span>
 
 class MathLib {
 public:
     static RunTimeVal* getStruct();
 
+    // sqrt, exp and log take a number or an array ( plain or typed ), an array gives back a Float64Array
     static RunTimeVal* mathSqrt(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathExp(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathLog(COMPILED_FUNC_ARGS);
     static RunTimeVal* mathPow(COMPILED_FUNC_ARGS);
     static RunTimeVal* mathRand(COMPILED_FUNC_ARGS);
-};
\ No newline at end of file
+
+    // elementwise over arrays of the same length, into a new Float64Array
+    static RunTimeVal* mathAdd(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathMul(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathFma(COMPILED_FUNC_ARGS);
+    // reductions over an array to one number
+    static RunTimeVal* mathSum(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathMin(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathMax(COMPILED_FUNC_ARGS);
+    static RunTimeVal* mathDot(COMPILED_FUNC_ARGS);
+
+private:
+    // the doubles of a Float64Array as they are, anything else converted into scratch
+    static std::span<const double> getSpan(RunTimeVal* val, std::vector<double>& scratch, const std::string& func_name);
+    static TypedArrayVal* makeResult(size_t size);
+    static void checkSameLength(std::span<const double> a, std::span<const double> b, const std::string& func_name);
+};
@@ -1,5 +1,9 @@
 #include "ArrayWrapper.h"
 #include "../../SigmaInterpreter.h"
+#include "../../Util/Util.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <unordered_map>
 
 std::unordered_map<std::string, RunTimeVal*> ArrayWrapper::funcs = {};
@@ -24,6 +28,8 @@ void ArrayWrapper::initializeWrapper() {
        {"clear", RunTimeFactory::makeNativeFunction(&ArrayWrapper::clear, {})},
        {"resize", RunTimeFactory::makeNativeFunction(&ArrayWrapper::resize, {{"new_size", NumType}})},
        {"slice", RunTimeFactory::makeNativeFunction(&ArrayWrapper::slice, {{"starting_index", NumType}, {"size", NumType}})},
+       {"sort", RunTimeFactory::makeNativeFunction(&ArrayWrapper::sort, {{"comparator", LambdaType, true}})},
+       {"binarySearch", RunTimeFactory::makeNativeFunction(&ArrayWrapper::binarySearch, {{"val", AnyType}, {"comparator", LambdaType, true}})},
        {"is_primitive", RunTimeFactory::makeString("array")}
     };
 };
@@ -228,4 +234,157 @@ RunTimeVal* ArrayWrapper::slice(COMPILED_FUNC_ARGS) {
     }
 
     return ArrayWrapper::genObject(new_array);
-};
\ No newline at end of file
+};
+
+// what sort and binarySearch can compare without calling back into the script
+enum SortKeyKind {
+    NoSortKey, NumberSortKey, StringSortKey
+};
+
+static RunTimeVal* getSortPrimitive(RunTimeVal* val) {
+    if(val) Util::SigmaInterpreterHelper::cvtToPrimitiveIfWrapper(&val);
+    return val;
+};
+
+static SortKeyKind getSortKeyKind(RunTimeVal* val) {
+    val = getSortPrimitive(val);
+    if(!val) return NoSortKey;
+    if(val->type == NumType) return NumberSortKey;
+    if(val->type == StringType) return StringSortKey;
+    return NoSortKey;
+};
+
+static SortKeyKind getSortKeyKind(const std::vector<RunTimeVal*>& vals) {
+    if(vals.empty()) return NumberSortKey;
+    SortKeyKind kind = getSortKeyKind(vals[0]);
+    for(RunTimeVal* val : vals){
+        if(getSortKeyKind(val) != kind)
+            return NoSortKey;
+    }
+    return kind;
+};
+
+static double getSortNumber(RunTimeVal* val) {
+    return static_cast<NumVal*>(getSortPrimitive(val))->num;
+};
+static const std::string& getSortString(RunTimeVal* val) {
+    return static_cast<StringVal*>(getSortPrimitive(val))->str;
+};
+
+// whether a goes before b by the script's comparator
+static bool comesBefore(SigmaInterpreter* interpreter, LambdaVal* comparator, RunTimeVal* a, RunTimeVal* b) {
+    RunTimeVal* result = interpreter->evaluateAnonymousLambdaCall(comparator, {a, b});
+    if(result && result->type == BoolType)
+        return static_cast<BoolVal*>(result)->boolean;
+    if(result && result->type == NumType)
+        return static_cast<NumVal*>(result)->num < 0;
+    throw std::runtime_error("sort comparator must return a Bool or a Number");
+};
+
+// bottom up and stable. it only ever indexes its own two buffers, so a comparator that isn't a
+// strict weak ordering gives some permutation of the input rather than reading out of bounds
+template<typename Before>
+static void mergeSort(std::vector<RunTimeVal*>& vals, Before before) {
+    std::vector<RunTimeVal*> scratch(vals.size());
+    for(size_t width = 1; width < vals.size(); width *= 2){
+        for(size_t start = 0; start < vals.size(); start += 2 * width){
+            size_t mid = std::min(start + width, vals.size());
+            size_t end = std::min(start + 2 * width, vals.size());
+            size_t left = start, right = mid, out = start;
+            while(left < mid && right < end)
+                scratch[out++] = before(vals[right], vals[left]) ? vals[right++] : vals[left++];
+            while(left < mid) scratch[out++] = vals[left++];
+            while(right < end) scratch[out++] = vals[right++];
+        }
+        vals.swap(scratch);
+    }
+};
+
+RunTimeVal* ArrayWrapper::sort(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    ArrayVal* primitive = static_cast<ArrayVal*>(object->vals["primitive"]);
+    std::vector<RunTimeVal*>& vals = primitive->vals;
+
+    if(args.size() > 0){
+        LambdaVal* comparator = static_cast<LambdaVal*>(args[0]);
+        // sorted on a protected copy, the comparator can grow, shrink or clear the array and
+        // a collection it triggers still sees every element. whatever it did to the array is
+        // replaced by the sorted copy once it's done
+        std::vector<RunTimeVal*>& sorted = Util::SigmaInterpreterHelper::protectForCall(interpreter, vals)->vals;
+        mergeSort(sorted, [&](RunTimeVal* a, RunTimeVal* b){
+            return comesBefore(interpreter, comparator, a, b);
+        });
+        vals = sorted;
+        return nullptr;
+    }
+
+    switch(getSortKeyKind(vals)){
+        case NumberSortKey: {
+            // NaN breaks the ordering std::sort relies on, they go last
+            auto nan_start = std::partition(vals.begin(), vals.end(), [](RunTimeVal* val){
+                return !std::isnan(getSortNumber(val));
+            });
+            std::sort(vals.begin(), nan_start, [](RunTimeVal* a, RunTimeVal* b){
+                return getSortNumber(a) < getSortNumber(b);
+            });
+            return nullptr;
+        }
+        case StringSortKey:
+            std::sort(vals.begin(), vals.end(), [](RunTimeVal* a, RunTimeVal* b){
+                return getSortString(a) < getSortString(b);
+            });
+            return nullptr;
+        default:
+            throw std::runtime_error("sort needs a comparator unless the array is all numbers or all strings");
+    }
+};
+
+RunTimeVal* ArrayWrapper::binarySearch(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    ArrayVal* primitive = static_cast<ArrayVal*>(object->vals["primitive"]);
+    std::vector<RunTimeVal*>& vals = primitive->vals;
+    RunTimeVal* target = args[0];
+
+    auto found = [&](std::vector<RunTimeVal*>::iterator itr, auto equals){
+        if(itr == vals.end() || !equals(*itr))
+            return RunTimeFactory::makeNum(-1);
+        return RunTimeFactory::makeNum(std::distance(vals.begin(), itr));
+    };
+
+    if(args.size() > 1){
+        LambdaVal* comparator = static_cast<LambdaVal*>(args[1]);
+        // searched on a protected copy for the same reason sort is
+        std::vector<RunTimeVal*>& searched = Util::SigmaInterpreterHelper::protectForCall(interpreter, vals)->vals;
+        auto itr = std::lower_bound(searched.begin(), searched.end(), target, [&](RunTimeVal* val, RunTimeVal* target){
+            return comesBefore(interpreter, comparator, val, target);
+        });
+        if(itr == searched.end() || comesBefore(interpreter, comparator, target, *itr))
+            return RunTimeFactory::makeNum(-1);
+        return RunTimeFactory::makeNum(std::distance(searched.begin(), itr));
+    }
+
+    const char* mismatch = "binarySearch needs a comparator unless the array and val are all numbers or all strings";
+    SortKeyKind kind = getSortKeyKind(target);
+    if(kind == NoSortKey)
+        throw std::runtime_error(mismatch);
+    // only the O(log n) elements the search lands on are checked, a full scan would cost more than the search
+    auto checked = [&](RunTimeVal* val){
+        if(getSortKeyKind(val) != kind)
+            throw std::runtime_error(mismatch);
+        return val;
+    };
+
+    if(kind == NumberSortKey){
+        double num = getSortNumber(target);
+        auto itr = std::lower_bound(vals.begin(), vals.end(), num, [&](RunTimeVal* val, double num){
+            return getSortNumber(checked(val)) < num;
+        });
+        return found(itr, [&](RunTimeVal* val){ return getSortNumber(checked(val)) == num; });
+    }
+
+    const std::string& str = getSortString(target);
+    auto itr = std::lower_bound(vals.begin(), vals.end(), str, [&](RunTimeVal* val, const std::string& str){
+        return getSortString(checked(val)) < str;
+    });
+    return found(itr, [&](RunTimeVal* val){ return getSortString(checked(val)) == str; });
+};
@@ -28,4 +28,10 @@ public:
     static RunTimeVal* front(COMPILED_FUNC_ARGS);
     static RunTimeVal* resize(COMPILED_FUNC_ARGS);
     static RunTimeVal* slice(COMPILED_FUNC_ARGS);
+    // in place, numbers and strings sort natively, anything else needs a comparator ( a, b ) that
+    // says whether a goes before b ( a Bool, or a Number below 0 ). anything the comparator does
+    // to the array itself is overwritten by the sorted result
+    static RunTimeVal* sort(COMPILED_FUNC_ARGS);
+    // index of val in an array sorted the same way, -1 if it isn't there
+    static RunTimeVal* binarySearch(COMPILED_FUNC_ARGS);
 };
\ No newline at end of file
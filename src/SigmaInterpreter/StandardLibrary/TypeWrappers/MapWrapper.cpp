@@ -0,0 +1,132 @@
+#include "MapWrapper.h"
+#include "ArrayWrapper.h"
+#include "StringWrapper.h"
+#include "../../SigmaInterpreter.h"
+#include "../../Util/Util.h"
+#include <unordered_map>
+
+std::unordered_map<std::string, RunTimeVal*> MapWrapper::funcs = {};
+
+// keys go back to scripts as the wrapped values a literal would give
+static RunTimeVal* wrapKey(const CollectionKey& key) {
+    RunTimeVal* val = CollectionKeyHelper::fromKey(key);
+    if(val->type == StringType)
+        return StringWrapper::genObject(static_cast<StringVal*>(val));
+    return val;
+};
+
+void MapWrapper::initializeWrapper() {
+    funcs = {
+        {"get", RunTimeFactory::makeNativeFunction(&MapWrapper::get, {{"key", AnyType}})},
+        {"set", RunTimeFactory::makeNativeFunction(&MapWrapper::set, {{"key", AnyType}, {"val", AnyType}})},
+        {"has", RunTimeFactory::makeNativeFunction(&MapWrapper::has, {{"key", AnyType}})},
+        {"remove", RunTimeFactory::makeNativeFunction(&MapWrapper::remove, {{"key", AnyType}})},
+        {"size", RunTimeFactory::makeNativeFunction(&MapWrapper::size, {})},
+        {"keys", RunTimeFactory::makeNativeFunction(&MapWrapper::keys, {})},
+        {"values", RunTimeFactory::makeNativeFunction(&MapWrapper::values, {})},
+        {"clear", RunTimeFactory::makeNativeFunction(&MapWrapper::clear, {})},
+        {"forEach", RunTimeFactory::makeNativeFunction(&MapWrapper::forEach, {{"function", LambdaType}})},
+        {"is_primitive", RunTimeFactory::makeString("map")}
+    };
+};
+
+ObjectVal* MapWrapper::genObject(MapVal* map) {
+    std::unordered_map<std::string, RunTimeVal*> vals = {
+    {"primitive", map},
+    };
+
+    for(auto& func : funcs){
+        vals.insert(func);
+    }
+
+    return RunTimeFactory::makeStruct(vals);
+};
+
+// null when the key isn't there
+RunTimeVal* MapWrapper::get(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+
+    auto itr = primitive->entries.find(CollectionKeyHelper::toKey(args[0]));
+    if(itr == primitive->entries.end())
+        return RunTimeFactory::makeVal<NullVal>();
+    return itr->second;
+};
+RunTimeVal* MapWrapper::set(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+
+    primitive->entries.insert_or_assign(CollectionKeyHelper::toKey(args[0]), interpreter->copyIfRecommended(args[1]));
+    return nullptr;
+};
+RunTimeVal* MapWrapper::has(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeBool(primitive->entries.contains(CollectionKeyHelper::toKey(args[0])));
+};
+RunTimeVal* MapWrapper::remove(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeBool(primitive->entries.erase(CollectionKeyHelper::toKey(args[0])) > 0);
+};
+RunTimeVal* MapWrapper::size(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeNum(primitive->entries.size());
+};
+
+RunTimeVal* MapWrapper::keys(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+    ArrayVal* new_arr = RunTimeFactory::makeArray({});
+    new_arr->vals.reserve(primitive->entries.size());
+
+    for(auto& [key, val] : primitive->entries){
+        new_arr->vals.push_back(wrapKey(key));
+    }
+    return ArrayWrapper::genObject(new_arr);
+};
+RunTimeVal* MapWrapper::values(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+    ArrayVal* new_arr = RunTimeFactory::makeArray({});
+    new_arr->vals.reserve(primitive->entries.size());
+
+    for(auto& [key, val] : primitive->entries){
+        new_arr->vals.push_back(val);
+    }
+    return ArrayWrapper::genObject(new_arr);
+};
+RunTimeVal* MapWrapper::clear(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+
+    primitive->entries.clear();
+    return nullptr;
+};
+
+// function ( key, val ), over a snapshot so the function can change the map. the snapshot's
+// values are protected, one the function removes is still alive when its turn comes
+RunTimeVal* MapWrapper::forEach(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    MapVal* primitive = static_cast<MapVal*>(object->vals["primitive"]);
+    LambdaVal* call = static_cast<LambdaVal*>(args[0]);
+
+    std::vector<CollectionKey> keys;
+    std::vector<RunTimeVal*> vals;
+    keys.reserve(primitive->entries.size());
+    vals.reserve(primitive->entries.size());
+    for(auto& [key, val] : primitive->entries){
+        keys.push_back(key);
+        vals.push_back(val);
+    }
+    std::vector<RunTimeVal*>& protected_vals = Util::SigmaInterpreterHelper::protectForCall(interpreter, std::move(vals))->vals;
+
+    for(size_t i = 0; i < keys.size(); i++){
+        interpreter->evaluateAnonymousLambdaCall(call, {wrapKey(keys[i]), protected_vals[i]});
+    }
+    return nullptr;
+};
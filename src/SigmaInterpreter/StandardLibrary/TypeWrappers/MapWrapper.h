@@ -0,0 +1,21 @@
+#pragma once
+#include "../StdLib.h"
+#include <unordered_map>
+
+// get and set here read and write entries, like a js Map, rather than swap the primitive
+class MapWrapper {
+public:
+    static ObjectVal* genObject(MapVal* map);
+    static std::unordered_map<std::string, RunTimeVal*> funcs;
+
+    static void initializeWrapper();
+    static RunTimeVal* get(COMPILED_FUNC_ARGS);
+    static RunTimeVal* set(COMPILED_FUNC_ARGS);
+    static RunTimeVal* has(COMPILED_FUNC_ARGS);
+    static RunTimeVal* remove(COMPILED_FUNC_ARGS);
+    static RunTimeVal* size(COMPILED_FUNC_ARGS);
+    static RunTimeVal* keys(COMPILED_FUNC_ARGS);
+    static RunTimeVal* values(COMPILED_FUNC_ARGS);
+    static RunTimeVal* clear(COMPILED_FUNC_ARGS);
+    static RunTimeVal* forEach(COMPILED_FUNC_ARGS);
+};
@@ -0,0 +1,107 @@
+#include "SetWrapper.h"
+#include "ArrayWrapper.h"
+#include "StringWrapper.h"
+#include "../../SigmaInterpreter.h"
+#include <unordered_map>
+
+std::unordered_map<std::string, RunTimeVal*> SetWrapper::funcs = {};
+
+static RunTimeVal* wrapKey(const CollectionKey& key) {
+    RunTimeVal* val = CollectionKeyHelper::fromKey(key);
+    if(val->type == StringType)
+        return StringWrapper::genObject(static_cast<StringVal*>(val));
+    return val;
+};
+
+void SetWrapper::initializeWrapper() {
+    funcs = {
+        {"get", RunTimeFactory::makeNativeFunction(&SetWrapper::get, {})},
+        {"set", RunTimeFactory::makeNativeFunction(&SetWrapper::set, {})},
+        {"add", RunTimeFactory::makeNativeFunction(&SetWrapper::add, {{"val", AnyType}})},
+        {"has", RunTimeFactory::makeNativeFunction(&SetWrapper::has, {{"val", AnyType}})},
+        {"remove", RunTimeFactory::makeNativeFunction(&SetWrapper::remove, {{"val", AnyType}})},
+        {"size", RunTimeFactory::makeNativeFunction(&SetWrapper::size, {})},
+        {"values", RunTimeFactory::makeNativeFunction(&SetWrapper::values, {})},
+        {"clear", RunTimeFactory::makeNativeFunction(&SetWrapper::clear, {})},
+        {"forEach", RunTimeFactory::makeNativeFunction(&SetWrapper::forEach, {{"function", LambdaType}})},
+        {"is_primitive", RunTimeFactory::makeString("set")}
+    };
+};
+
+ObjectVal* SetWrapper::genObject(SetVal* set) {
+    std::unordered_map<std::string, RunTimeVal*> vals = {
+    {"primitive", set},
+    };
+
+    for(auto& func : funcs){
+        vals.insert(func);
+    }
+
+    return RunTimeFactory::makeStruct(vals);
+};
+
+RunTimeVal* SetWrapper::get(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    return object->vals["primitive"];
+};
+RunTimeVal* SetWrapper::set(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    object->vals["primitive"] = args[0];
+    return args[0];
+};
+
+// true if the value wasn't in the set yet
+RunTimeVal* SetWrapper::add(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeBool(primitive->keys.insert(CollectionKeyHelper::toKey(args[0])).second);
+};
+RunTimeVal* SetWrapper::has(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeBool(primitive->keys.contains(CollectionKeyHelper::toKey(args[0])));
+};
+RunTimeVal* SetWrapper::remove(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeBool(primitive->keys.erase(CollectionKeyHelper::toKey(args[0])) > 0);
+};
+RunTimeVal* SetWrapper::size(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeNum(primitive->keys.size());
+};
+
+RunTimeVal* SetWrapper::values(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+    ArrayVal* new_arr = RunTimeFactory::makeArray({});
+    new_arr->vals.reserve(primitive->keys.size());
+
+    for(auto& key : primitive->keys){
+        new_arr->vals.push_back(wrapKey(key));
+    }
+    return ArrayWrapper::genObject(new_arr);
+};
+RunTimeVal* SetWrapper::clear(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+
+    primitive->keys.clear();
+    return nullptr;
+};
+RunTimeVal* SetWrapper::forEach(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    SetVal* primitive = static_cast<SetVal*>(object->vals["primitive"]);
+    LambdaVal* call = static_cast<LambdaVal*>(args[0]);
+
+    std::vector<CollectionKey> keys(primitive->keys.begin(), primitive->keys.end());
+    for(auto& key : keys){
+        interpreter->evaluateAnonymousLambdaCall(call, {wrapKey(key)});
+    }
+    return nullptr;
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include "../StdLib.h"
+#include <unordered_map>
+
+class SetWrapper {
+public:
+    static ObjectVal* genObject(SetVal* set);
+    static std::unordered_map<std::string, RunTimeVal*> funcs;
+
+    static void initializeWrapper();
+    static RunTimeVal* get(COMPILED_FUNC_ARGS);
+    static RunTimeVal* set(COMPILED_FUNC_ARGS);
+    static RunTimeVal* add(COMPILED_FUNC_ARGS);
+    static RunTimeVal* has(COMPILED_FUNC_ARGS);
+    static RunTimeVal* remove(COMPILED_FUNC_ARGS);
+    static RunTimeVal* size(COMPILED_FUNC_ARGS);
+    static RunTimeVal* values(COMPILED_FUNC_ARGS);
+    static RunTimeVal* clear(COMPILED_FUNC_ARGS);
+    static RunTimeVal* forEach(COMPILED_FUNC_ARGS);
+};
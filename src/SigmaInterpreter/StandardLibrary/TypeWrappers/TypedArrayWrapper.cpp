@@ -0,0 +1,107 @@
+#include "TypedArrayWrapper.h"
+#include "ArrayWrapper.h"
+#include "../../SigmaInterpreter.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+std::unordered_map<std::string, RunTimeVal*> TypedArrayWrapper::funcs = {};
+
+void TypedArrayWrapper::initializeWrapper() {
+    funcs = {
+        {"get", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::get, {})},
+        {"set", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::set, {})},
+        {"length", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::length, {})},
+        {"resize", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::resize, {{"new_size", NumType}})},
+        {"fill", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::fill, {{"val", NumType}})},
+        {"sum", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::sum, {})},
+        {"forEach", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::forEach, {{"function", LambdaType}})},
+        {"toArray", RunTimeFactory::makeNativeFunction(&TypedArrayWrapper::toArray, {})},
+        {"is_primitive", RunTimeFactory::makeString("typed_array")}
+    };
+};
+
+ObjectVal* TypedArrayWrapper::genObject(TypedArrayVal* array) {
+    std::unordered_map<std::string, RunTimeVal*> vals = {
+    {"primitive", array},
+    };
+
+    for(auto& func : funcs){
+        vals.insert(func);
+    }
+
+    return RunTimeFactory::makeStruct(vals);
+};
+
+RunTimeVal* TypedArrayWrapper::get(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    return object->vals["primitive"];
+};
+RunTimeVal* TypedArrayWrapper::set(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    object->vals["primitive"] = args[0];
+    return args[0];
+};
+
+RunTimeVal* TypedArrayWrapper::length(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    TypedArrayVal* primitive = static_cast<TypedArrayVal*>(object->vals["primitive"]);
+
+    return RunTimeFactory::makeNum(primitive->length());
+};
+RunTimeVal* TypedArrayWrapper::resize(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    TypedArrayVal* primitive = static_cast<TypedArrayVal*>(object->vals["primitive"]);
+    double new_size = static_cast<NumVal*>(args[0])->num;
+    if(!TypedArrayVal::isValidLength(new_size))
+        throw std::runtime_error("resize Excepts arg 0 to be a number between 0 and 4294967295");
+
+    primitive->resize(static_cast<size_t>(new_size));
+    return nullptr;
+};
+
+RunTimeVal* TypedArrayWrapper::fill(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    TypedArrayVal* primitive = static_cast<TypedArrayVal*>(object->vals["primitive"]);
+    double num = static_cast<NumVal*>(args[0])->num;
+
+    if(primitive->kind == TypedArrayVal::Float64Elements)
+        std::fill(primitive->floats.begin(), primitive->floats.end(), num);
+    else
+        std::fill(primitive->ints.begin(), primitive->ints.end(), TypedArrayVal::toInt32(num));
+    return nullptr;
+};
+RunTimeVal* TypedArrayWrapper::sum(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    TypedArrayVal* primitive = static_cast<TypedArrayVal*>(object->vals["primitive"]);
+
+    // int32 elements add up in a double, the total can't overflow
+    if(primitive->kind == TypedArrayVal::Float64Elements)
+        return RunTimeFactory::makeNum(std::accumulate(primitive->floats.begin(), primitive->floats.end(), 0.0));
+    return RunTimeFactory::makeNum(std::accumulate(primitive->ints.begin(), primitive->ints.end(), 0.0));
+};
+
+RunTimeVal* TypedArrayWrapper::forEach(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    TypedArrayVal* primitive = static_cast<TypedArrayVal*>(object->vals["primitive"]);
+    LambdaVal* call = static_cast<LambdaVal*>(args[0]);
+
+    for(size_t i = 0; i < primitive->length(); i++){
+        interpreter->evaluateAnonymousLambdaCall(call, {RunTimeFactory::makeNum(primitive->get(i))});
+    }
+
+    return nullptr;
+};
+
+RunTimeVal* TypedArrayWrapper::toArray(COMPILED_FUNC_ARGS) {
+    ObjectVal* object = interpreter->getThis();
+    TypedArrayVal* primitive = static_cast<TypedArrayVal*>(object->vals["primitive"]);
+    ArrayVal* new_arr = RunTimeFactory::makeArray({});
+    new_arr->vals.reserve(primitive->length());
+
+    for(size_t i = 0; i < primitive->length(); i++){
+        new_arr->vals.push_back(RunTimeFactory::makeNum(primitive->get(i)));
+    }
+
+    return ArrayWrapper::genObject(new_arr);
+};
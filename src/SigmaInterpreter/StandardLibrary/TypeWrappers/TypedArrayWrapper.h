@@ -0,0 +1,20 @@
+#pragma once
+#include "../StdLib.h"
+#include <unordered_map>
+
+class TypedArrayWrapper {
+public:
+    static ObjectVal* genObject(TypedArrayVal* array);
+    static std::unordered_map<std::string, RunTimeVal*> funcs;
+
+    static void initializeWrapper();
+    static RunTimeVal* get(COMPILED_FUNC_ARGS);
+    static RunTimeVal* set(COMPILED_FUNC_ARGS);
+    static RunTimeVal* length(COMPILED_FUNC_ARGS);
+    static RunTimeVal* resize(COMPILED_FUNC_ARGS);
+    static RunTimeVal* fill(COMPILED_FUNC_ARGS);
+    static RunTimeVal* sum(COMPILED_FUNC_ARGS);
+    static RunTimeVal* forEach(COMPILED_FUNC_ARGS);
+    // a plain Array of NumVals, for code that wants one
+    static RunTimeVal* toArray(COMPILED_FUNC_ARGS);
+};
@@ -0,0 +1,38 @@
+#include "TypedArrayLib.h"
+#include "../TypeWrappers/TypedArrayWrapper.h"
+#include <stdexcept>
+
+ObjectVal* TypedArrayLib::getStruct(TypedArrayVal::ElementKind kind) {
+    std::unordered_map<std::string, RunTimeVal*> vals = {
+        {"create", RunTimeFactory::makeNativeFunction([kind](COMPILED_FUNC_ARGS) {
+            return TypedArrayLib::create(kind, args, interpreter);
+        }, {{"size", NumType}})},
+        {"from", RunTimeFactory::makeNativeFunction([kind](COMPILED_FUNC_ARGS) {
+            return TypedArrayLib::from(kind, args, interpreter);
+        }, {{"array", ArrayType}})}
+    };
+
+    return RunTimeFactory::makeStruct(std::move(vals));
+};
+
+RunTimeValue TypedArrayLib::create(TypedArrayVal::ElementKind kind, std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    double size = static_cast<NumVal*>(args[0])->num;
+    if(!TypedArrayVal::isValidLength(size))
+        throw std::runtime_error("create Excepts arg 0 to be a number between 0 and 4294967295");
+
+    return TypedArrayWrapper::genObject(RunTimeFactory::makeTypedArray(kind, static_cast<size_t>(size)));
+};
+
+RunTimeValue TypedArrayLib::from(TypedArrayVal::ElementKind kind, std::vector<RunTimeValue>& args, SigmaInterpreter*) {
+    auto array = static_cast<ArrayVal*>(args[0]);
+    TypedArrayVal* typed_array = RunTimeFactory::makeTypedArray(kind, array->vals.size());
+
+    for(size_t i = 0; i < array->vals.size(); i++){
+        if(!array->vals[i] || array->vals[i]->type != NumType)
+            throw std::runtime_error("from Excepts an array of numbers, element " +
+                std::to_string(i) + " isn't one");
+        typed_array->set(i, static_cast<NumVal*>(array->vals[i])->num);
+    }
+
+    return TypedArrayWrapper::genObject(typed_array);
+};
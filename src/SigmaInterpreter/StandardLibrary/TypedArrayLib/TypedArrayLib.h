@@ -0,0 +1,11 @@
+#pragma once
+#include "../StdLib.h"
+
+// Float64Array And Int32Array, Both Built Through create ( size ) Or from ( array )
+class TypedArrayLib {
+public:
+    static ObjectVal* getStruct(TypedArrayVal::ElementKind kind);
+
+    static RunTimeValue create(TypedArrayVal::ElementKind kind, std::vector<RunTimeValue>& args, SigmaInterpreter*);
+    static RunTimeValue from(TypedArrayVal::ElementKind kind, std::vector<RunTimeValue>& args, SigmaInterpreter*);
+};
@@ -12,8 +12,13 @@
 #include "../StandardLibrary/TimeLib/TimeLib.h"
 #include "../StandardLibrary/MathLib/MathLib.h"
 #include "../StandardLibrary/WindowLib/WindowLib.h"
+#include "../StandardLibrary/TypedArrayLib/TypedArrayLib.h"
+#include "../StandardLibrary/CollectionLib/CollectionLib.h"
 #include "../StandardLibrary/TypeWrappers/ArrayWrapper.h"
 #include "../StandardLibrary/TypeWrappers/StringWrapper.h"
+#include "../StandardLibrary/TypeWrappers/TypedArrayWrapper.h"
+#include "../StandardLibrary/TypeWrappers/MapWrapper.h"
+#include "../StandardLibrary/TypeWrappers/SetWrapper.h"
 #include <algorithm>
 #include <memory>
 #include <iostream>
@@ -33,6 +38,10 @@ void Util::SigmaInterpreterHelper::initializeStandardLibraries(std::shared_ptr<S
     target_scope->declareVar("Math", { MathLib::getStruct(), true });
     target_scope->declareVar("Window", {WindowLib::getStruct(), true});
     target_scope->declareVar("Permissions", {PermissionLib::getStruct(), true});
+    target_scope->declareVar("Float64Array", {TypedArrayLib::getStruct(TypedArrayVal::Float64Elements), true});
+    target_scope->declareVar("Int32Array", {TypedArrayLib::getStruct(TypedArrayVal::Int32Elements), true});
+    target_scope->declareVar("Map", {CollectionLib::getMapStruct(), true});
+    target_scope->declareVar("Set", {CollectionLib::getSetStruct(), true});
 };
 
 LambdaVal* Util::SigmaInterpreterHelper::evaluateLambda(std::shared_ptr<Scope>& target_scope,
@@ -242,17 +251,36 @@ void Util::SigmaInterpreterHelper::cvtToPrimitiveIfWrapper(RunTimeVal** val) {
                     *val = static_cast<ArrayVal*>(obj_val->vals["primitive"]);
                 } else if (target_string_val->str == "string"){
                     *val = static_cast<StringVal*>(obj_val->vals["primitive"]);
+                } else if (target_string_val->str == "typed_array"){
+                    *val = static_cast<TypedArrayVal*>(obj_val->vals["primitive"]);
+                } else if (target_string_val->str == "map"){
+                    *val = static_cast<MapVal*>(obj_val->vals["primitive"]);
+                } else if (target_string_val->str == "set"){
+                    *val = static_cast<SetVal*>(obj_val->vals["primitive"]);
                 }
             }
         }
     }
 };
 
+ArrayVal* Util::SigmaInterpreterHelper::protectForCall(SigmaInterpreter* self, std::vector<RunTimeVal*> vals) {
+    ArrayVal* protected_vals = RunTimeFactory::makeArray(std::move(vals));
+    // not a name a script can spell, so nothing it runs can reach or replace it
+    self->current_scope->declareVar("#protected", { protected_vals, true });
+    return protected_vals;
+};
+
 RunTimeVal* Util::SigmaInterpreterHelper::cvtToWrapperIfPossible(RunTimeVal* val) {
     if(val->type == StringType)
         return StringWrapper::genObject(static_cast<StringVal*>(val));
     else if(val->type == ArrayType)
         return ArrayWrapper::genObject(static_cast<ArrayVal*>(val));
+    else if(val->type == TypedArrayType)
+        return TypedArrayWrapper::genObject(static_cast<TypedArrayVal*>(val));
+    else if(val->type == MapType)
+        return MapWrapper::genObject(static_cast<MapVal*>(val));
+    else if(val->type == SetType)
+        return SetWrapper::genObject(static_cast<SetVal*>(val));
 
     return val;
 };
\ No newline at end of file
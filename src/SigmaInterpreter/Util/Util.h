@@ -30,5 +30,8 @@ namespace Util {
         );
         static void cvtToPrimitiveIfWrapper(RunTimeVal** val);
         static RunTimeVal* cvtToWrapperIfPossible(RunTimeVal* val);
+        // for native functions that call back into the script, keeps vals alive in the
+        // native call's scope until it returns, whatever the script does to where they came from
+        static ArrayVal* protectForCall(SigmaInterpreter* self, std::vector<RunTimeVal*> vals);
     };
 };
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "ComputedStyleCache.h"
+#include "../Interpreter/StyleManagement/InlineStyleRegistry.h"
+#include <algorithm>
+#include <functional>
+
+size_t StyleRecordKeyHash::operator()(const StyleRecordKey& key) const {
+    std::hash<std::string> string_hash;
+    size_t seed = string_hash(key.tag_name);
+    auto combine = [&seed](size_t value){
+        seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    };
+
+    combine(string_hash(key.id));
+    for(auto& class_name : key.classes)
+        combine(string_hash(class_name));
+    combine(std::hash<const ComputedStyleRecord*>()(key.parent));
+    return seed;
+};
+
+ComputedStyleRecordPtr ComputedStyleCache::resolve(const StyleRuleSet& rules, StyleRecordKey key,
+    ComputedStyleRecordPtr parent_record) {
+    key.parent = parent_record.get();
+    auto itr = records.find(key);
+    if(itr != records.end()){
+        hits++;
+        return itr->second;
+    }
+    misses++;
+
+    // the parent chain already holds every ancestor's matching inputs, root last
+    std::vector<SelectorSubject> ancestors;
+    for(const ComputedStyleRecord* record = parent_record.get(); record != nullptr;
+        record = record->parent_record.get())
+        ancestors.push_back({record->key.tag_name, record->key.id, &record->key.classes});
+    std::reverse(ancestors.begin(), ancestors.end());
+
+    auto record = std::make_shared<ComputedStyleRecord>();
+    record->key = std::move(key);
+    record->parent_record = std::move(parent_record);
+
+    SelectorSubject subject = {record->key.tag_name, record->key.id, &record->key.classes};
+    std::string style = rules.computeStyle(subject, ancestors).serialize();
+    if(!style.empty())
+        record->sheet_class = InlineStyleRegistry::getClassForStyle(style, SheetStyleLayer);
+
+    records.insert({record->key, record});
+    return record;
+};
+
+void ComputedStyleCache::clear() {
+    records.clear();
+    hits = 0;
+    misses = 0;
+};
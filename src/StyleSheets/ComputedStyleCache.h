@@ -0,0 +1,57 @@
+#pragma once
+#include "StyleRuleSet.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+//  Interns Resolved Styles By Everything Selector Matching Can See: The Element's Own
+//  Tag, Id And Classes Plus Its Parent's Record ( Which Recursively Stands For The
+//  Whole Ancestor Chain ). Siblings With The Same Inputs Share One Record, So The
+//  Rules Run Once Per Distinct Key Instead Of Once Per Element
+//
+
+struct ComputedStyleRecord;
+
+// only the parts some selector refers to end up in the key, the rest can't change a match
+struct StyleRecordKey {
+    std::string tag_name;
+    std::string id;
+    std::vector<std::string> classes;
+    const ComputedStyleRecord* parent = nullptr;
+
+    bool operator==(const StyleRecordKey& other) const = default;
+};
+
+struct StyleRecordKeyHash {
+    size_t operator()(const StyleRecordKey& key) const;
+};
+
+struct ComputedStyleRecord {
+    StyleRecordKey key;
+    // keeps the chain alive for tags still pointing at records of a cleared cache
+    std::shared_ptr<const ComputedStyleRecord> parent_record;
+    // generated by the InlineStyleRegistry sheet layer, empty when no rule matched
+    std::string sheet_class;
+};
+
+typedef std::shared_ptr<const ComputedStyleRecord> ComputedStyleRecordPtr;
+
+class ComputedStyleCache {
+public:
+    // the key's parent is filled in from parent_record
+    ComputedStyleRecordPtr resolve(const StyleRuleSet& rules, StyleRecordKey key,
+        ComputedStyleRecordPtr parent_record);
+    // records are only valid for the rules they were computed with
+    void clear();
+
+    size_t size() const { return records.size(); };
+    size_t getHits() const { return hits; };
+    size_t getMisses() const { return misses; };
+
+private:
+    std::unordered_map<StyleRecordKey, ComputedStyleRecordPtr, StyleRecordKeyHash> records;
+    size_t hits = 0;
+    size_t misses = 0;
+};
@@ -0,0 +1,76 @@
+#include "StyleResolver.h"
+#include "../Interpreter/Ast.h"
+#include "../Interpreter/StyleManagement/InlineStyleRegistry.h"
+
+void StyleResolver::resolveStyles(const StyleRuleSet& rules, ComputedStyleCache& cache,
+    std::vector<std::shared_ptr<HTMLTag>>& root_tags) {
+    if(rules.empty())
+        return;
+
+    for(auto& tag : root_tags)
+        resolveTag(rules, cache, tag.get(), nullptr, false);
+};
+
+void StyleResolver::restyleSubtree(const StyleRuleSet& rules, ComputedStyleCache& cache, HTMLTag* tag) {
+    // never resolved means it isn't attached yet, the next full pass picks it up
+    if(rules.empty() || !tag->style_record)
+        return;
+
+    ComputedStyleRecordPtr parent_record = tag->style_record->parent_record;
+    resolveTag(rules, cache, tag, parent_record, true);
+};
+
+StyleRecordKey StyleResolver::makeKey(const StyleRuleSet& rules, HTMLTag* tag) {
+    StyleRecordKey key;
+    const std::string& tag_name = tag->tag_information.html_elm_name;
+    // .h1 matches <h1> too ( see SelectorSubject::hasClass ), so the tag counts if either mentions it
+    if(rules.referencesTag(tag_name) || rules.referencesClass(tag_name))
+        key.tag_name = tag_name;
+
+    auto id_itr = tag->props.find("id");
+    if(id_itr != tag->props.end() && rules.referencesId(id_itr->second))
+        key.id = id_itr->second;
+
+    for(auto& class_name : tag->getStyleInputs().css_classes)
+        if(rules.referencesClass(class_name))
+            key.classes.push_back(class_name);
+    return key;
+};
+
+void StyleResolver::resolveTag(const StyleRuleSet& rules, ComputedStyleCache& cache, HTMLTag* tag,
+    const ComputedStyleRecordPtr& parent_record, bool stop_when_unchanged) {
+    // text nodes aren't selector subjects in html, they inherit from their parent's widget
+    if(tag->tag_information.type == String)
+        return;
+
+    ComputedStyleRecordPtr record = cache.resolve(rules, makeKey(rules, tag), parent_record);
+    bool unchanged = record == tag->style_record;
+    tag->style_record = record;
+    applySheetClass(tag, record->sheet_class);
+
+    // children key on this record, same record means every descendant resolves the same as before
+    if(unchanged && stop_when_unchanged)
+        return;
+
+    for(auto& child : tag->children)
+        resolveTag(rules, cache, child.get(), record, stop_when_unchanged);
+};
+
+void StyleResolver::applySheetClass(HTMLTag* tag, const std::string& new_class) {
+    Gtk::Widget* widget = tag->tag_information.current_widget;
+
+    if(widget != nullptr){
+        if(widget == tag->sheet_styled_widget){
+            if(new_class == tag->sheet_style_class)
+                return;
+            if(!tag->sheet_style_class.empty())
+                widget->remove_css_class(tag->sheet_style_class);
+        }
+        if(!new_class.empty())
+            widget->add_css_class(new_class);
+    }
+
+    // unrendered ( e.g virtualized ) tags pick the class up in their css manager once they render
+    tag->sheet_style_class = new_class;
+    tag->sheet_styled_widget = widget;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include "ComputedStyleCache.h"
+#include "StyleRuleSet.h"
+#include <memory>
+#include <vector>
+
+class HTMLTag;
+
+//
+//  Matches A StyleRuleSet Against The Html Tag Tree Through A ComputedStyleCache,
+//  Every Distinct Computed Style Becomes One Generated Class ( InlineStyleRegistry Sheet Layer )
+//  And A Widget Is Only Touched When Its Class Actually Changed Since The Last Pass
+//
+
+class StyleResolver {
+public:
+    // gtk thread only, root_tags are the top level tags of the page
+    static void resolveStyles(const StyleRuleSet& rules, ComputedStyleCache& cache,
+        std::vector<std::shared_ptr<HTMLTag>>& root_tags);
+    // after the tag's own class / id changed, stops descending once records come out unchanged
+    static void restyleSubtree(const StyleRuleSet& rules, ComputedStyleCache& cache, HTMLTag* tag);
+
+private:
+    static StyleRecordKey makeKey(const StyleRuleSet& rules, HTMLTag* tag);
+    static void resolveTag(const StyleRuleSet& rules, ComputedStyleCache& cache, HTMLTag* tag,
+        const ComputedStyleRecordPtr& parent_record, bool stop_when_unchanged);
+    static void applySheetClass(HTMLTag* tag, const std::string& new_class);
+};
@@ -0,0 +1,140 @@
+#include "StyleRuleSet.h"
+#include <algorithm>
+
+bool SelectorSubject::hasClass(std::string_view class_name) const {
+    // html_elm_name is added as a gtk class on every widget, so .h1 keeps matching <h1>
+    if(class_name == tag_name)
+        return true;
+    if(classes == nullptr)
+        return false;
+    return std::find(classes->begin(), classes->end(), class_name) != classes->end();
+};
+
+std::string ComputedStyle::serialize() const {
+    std::string result;
+    for(auto& [property, value] : properties)
+        result += property + ": " + value + "; ";
+    if(!result.empty())
+        result.pop_back();
+    return result;
+};
+
+void StyleRuleSet::addStyleSheet(StyleSheet sheet) {
+    for(auto& parsed_rule : sheet.rules){
+        const StyleRule& rule = rules.emplace_back(std::move(parsed_rule));
+
+        for(auto& selector : rule.selectors){
+            RuleEntry entry = {&rule, &selector, next_order};
+            for(auto& compound : selector.compounds){
+                if(!compound.id.empty()) referenced_ids.insert(compound.id);
+                if(!compound.tag_name.empty()) referenced_tags.insert(compound.tag_name);
+                referenced_classes.insert(compound.classes.begin(), compound.classes.end());
+            }
+            const CompoundSelector& key = selector.compounds.back();
+
+            if(!key.id.empty())
+                id_rules[key.id].push_back(entry);
+            else if(!key.classes.empty())
+                class_rules[key.classes.front()].push_back(entry);
+            else if(!key.tag_name.empty())
+                tag_rules[key.tag_name].push_back(entry);
+            else
+                universal_rules.push_back(entry);
+        }
+        next_order++;
+    }
+};
+
+void StyleRuleSet::clear() {
+    id_rules.clear();
+    class_rules.clear();
+    tag_rules.clear();
+    universal_rules.clear();
+    referenced_ids.clear();
+    referenced_classes.clear();
+    referenced_tags.clear();
+    rules.clear();
+    next_order = 0;
+};
+
+bool StyleRuleSet::matchesCompound(const CompoundSelector& compound, const SelectorSubject& subject) {
+    if(!compound.tag_name.empty() && compound.tag_name != subject.tag_name)
+        return false;
+    if(!compound.id.empty() && compound.id != subject.id)
+        return false;
+    for(auto& class_name : compound.classes)
+        if(!subject.hasClass(class_name))
+            return false;
+    return true;
+};
+
+bool StyleRuleSet::matchesSelector(const ComplexSelector& selector, const SelectorSubject& subject,
+    const std::vector<SelectorSubject>& ancestors) {
+    return matchesFrom(selector, selector.compounds.size() - 1, subject, ancestors, ancestors.size());
+};
+
+bool StyleRuleSet::matchesFrom(const ComplexSelector& selector, size_t compound_index,
+    const SelectorSubject& subject, const std::vector<SelectorSubject>& ancestors, size_t ancestor_count) {
+    if(!matchesCompound(selector.compounds[compound_index], subject))
+        return false;
+    if(compound_index == 0)
+        return true;
+
+    if(selector.combinators[compound_index - 1] == ChildCombinator)
+        return ancestor_count > 0 &&
+            matchesFrom(selector, compound_index - 1, ancestors[ancestor_count - 1], ancestors, ancestor_count - 1);
+
+    for(size_t i = ancestor_count; i-- > 0;)
+        if(matchesFrom(selector, compound_index - 1, ancestors[i], ancestors, i))
+            return true;
+    return false;
+};
+
+void StyleRuleSet::collectBucket(const std::unordered_map<std::string, std::vector<RuleEntry>>& bucket,
+    std::string_view key, const SelectorSubject& subject, const std::vector<SelectorSubject>& ancestors,
+    std::vector<const RuleEntry*>& matched) const {
+    if(key.empty())
+        return;
+    auto itr = bucket.find(std::string(key));
+    if(itr == bucket.end())
+        return;
+    for(auto& entry : itr->second)
+        if(matchesSelector(*entry.selector, subject, ancestors))
+            matched.push_back(&entry);
+};
+
+ComputedStyle StyleRuleSet::computeStyle(const SelectorSubject& subject,
+    const std::vector<SelectorSubject>& ancestors) const {
+    std::vector<const RuleEntry*> matched;
+
+    collectBucket(id_rules, subject.id, subject, ancestors, matched);
+    if(subject.classes != nullptr){
+        for(size_t i = 0; i < subject.classes->size(); i++){
+            const std::string& class_name = (*subject.classes)[i];
+            // each bucket once, even when class="a a"
+            if(std::find(subject.classes->begin(), subject.classes->begin() + i, class_name) ==
+                subject.classes->begin() + i && class_name != subject.tag_name)
+                collectBucket(class_rules, class_name, subject, ancestors, matched);
+        }
+    }
+    collectBucket(class_rules, subject.tag_name, subject, ancestors, matched);
+    collectBucket(tag_rules, subject.tag_name, subject, ancestors, matched);
+    for(auto& entry : universal_rules)
+        if(matchesSelector(*entry.selector, subject, ancestors))
+            matched.push_back(&entry);
+
+    std::sort(matched.begin(), matched.end(), [](const RuleEntry* lhs, const RuleEntry* rhs){
+        if(lhs->selector->specificity != rhs->selector->specificity)
+            return lhs->selector->specificity < rhs->selector->specificity;
+        return lhs->order < rhs->order;
+    });
+
+    ComputedStyle style;
+    for(bool important_pass : {false, true})
+        for(auto* entry : matched)
+            for(auto& declaration : entry->rule->declarations)
+                if(declaration.important == important_pass)
+                    style.properties[declaration.property] = declaration.value;
+
+    return style;
+};
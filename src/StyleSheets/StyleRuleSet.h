@@ -0,0 +1,72 @@
+#pragma once
+#include "StyleSheetParser.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//
+//  Rules Are Bucketed By The Rightmost Compound's Most Selective Part ( Id, Then Class, Then Tag ),
+//  So An Element Only Runs The Selectors That Could Possibly Match It Instead Of Every Rule
+//
+
+struct SelectorSubject {
+    std::string_view tag_name;
+    std::string_view id;
+    const std::vector<std::string>* classes = nullptr;
+
+    bool hasClass(std::string_view class_name) const;
+};
+
+struct ComputedStyle {
+    std::map<std::string, std::string> properties;
+
+    // stable "property: value;" text, identical styles serialize identically
+    std::string serialize() const;
+};
+
+class StyleRuleSet {
+public:
+    void addStyleSheet(StyleSheet sheet);
+    void clear();
+    bool empty() const { return rules.empty(); };
+
+    // ancestors are ordered root first, so the parent is ancestors.back()
+    ComputedStyle computeStyle(const SelectorSubject& subject,
+        const std::vector<SelectorSubject>& ancestors) const;
+
+    // an id / class / tag no selector mentions can never change which rules match
+    bool referencesId(const std::string& id) const { return referenced_ids.contains(id); };
+    bool referencesClass(const std::string& class_name) const { return referenced_classes.contains(class_name); };
+    bool referencesTag(const std::string& tag_name) const { return referenced_tags.contains(tag_name); };
+
+    static bool matchesCompound(const CompoundSelector& compound, const SelectorSubject& subject);
+    static bool matchesSelector(const ComplexSelector& selector, const SelectorSubject& subject,
+        const std::vector<SelectorSubject>& ancestors);
+
+private:
+    struct RuleEntry {
+        const StyleRule* rule;
+        const ComplexSelector* selector;
+        size_t order;
+    };
+
+    std::deque<StyleRule> rules;
+    std::unordered_map<std::string, std::vector<RuleEntry>> id_rules;
+    std::unordered_map<std::string, std::vector<RuleEntry>> class_rules;
+    std::unordered_map<std::string, std::vector<RuleEntry>> tag_rules;
+    std::vector<RuleEntry> universal_rules;
+    std::unordered_set<std::string> referenced_ids;
+    std::unordered_set<std::string> referenced_classes;
+    std::unordered_set<std::string> referenced_tags;
+    size_t next_order = 0;
+
+    static bool matchesFrom(const ComplexSelector& selector, size_t compound_index,
+        const SelectorSubject& subject, const std::vector<SelectorSubject>& ancestors, size_t ancestor_count);
+    void collectBucket(const std::unordered_map<std::string, std::vector<RuleEntry>>& bucket, std::string_view key,
+        const SelectorSubject& subject, const std::vector<SelectorSubject>& ancestors,
+        std::vector<const RuleEntry*>& matched) const;
+};
@@ -1,18 +1,140 @@
 #include "StyleSheetLexer.h"
 
 std::vector<StyleSheetToken> StyleSheetLexer::tokenize(std::string& code){
-    current_char = code[0];
-    current_pos = 0;
     actual_code = &code;
+    current_pos = 0;
+    current_char = code.empty() ? '\0' : code[0];
 
     std::vector<StyleSheetToken> tokens;
-    
+
     while(current_char != '\0' && current_pos < actual_code->size()){
-        while(skip_chars.contains(current_char) && current_char < '\0')
+        if(skip_chars.contains(current_char)){
+            while(skip_chars.contains(current_char))
+                advance();
+            // whitespace is kept ( collapsed ), it's the descendant combinator in selectors
+            tokens.push_back({StyleWhitespace, " "});
+            continue;
+        }
+
+        if(current_char == '/' && peek() == '*'){
+            skipComment();
+            continue;
+        }
+
+        if(current_char == '"' || current_char == '\''){
+            tokens.push_back(consumeString());
+            continue;
+        }
+
+        if(isDigit(current_char) || (current_char == '.' && isDigit(peek())) ||
+            ((current_char == '-' || current_char == '+') &&
+                (isDigit(peek()) || (peek() == '.' && isDigit(peek(2)))))){
+            tokens.push_back(consumeNumber());
+            continue;
+        }
+
+        if(current_char == '#' && isNameChar(peek())){
             advance();
+            tokens.push_back({StyleIdSelector, "#" + consumeName()});
+            continue;
+        }
+
+        if(current_char == '@' && isNameStart(peek())){
+            advance();
+            tokens.push_back({StyleAtKeyword, "@" + consumeName()});
+            continue;
+        }
+
+        if(isNameStart(current_char) && !(current_char == '-' && !isNameChar(peek()))){
+            tokens.push_back({StyleIdentifier, consumeName()});
+            continue;
+        }
+
+        std::string symbol(1, current_char);
+        auto itr = known_style_tokens.find(symbol);
+        if(itr != known_style_tokens.end())
+            tokens.push_back({itr->second, symbol});
+        else
+            tokens.push_back({StyleDelim, symbol});
+        advance();
     }
 
+    tokens.push_back({StyleEOF, ""});
+
     actual_code = nullptr;
     current_pos = 0;
     current_char = '0';
-};
\ No newline at end of file
+    return tokens;
+};
+
+std::string StyleSheetLexer::consumeName(){
+    std::string name;
+    while(current_char != '\0' && (isNameChar(current_char) || current_char == '\\')){
+        if(current_char == '\\'){
+            advance();
+            if(current_char == '\0') break;
+        }
+        name.push_back(current_char);
+        advance();
+    }
+    return name;
+};
+
+StyleSheetToken StyleSheetLexer::consumeNumber(){
+    std::string number;
+    if(current_char == '-' || current_char == '+'){
+        number.push_back(current_char);
+        advance();
+    }
+    while(isDigit(current_char)){
+        number.push_back(current_char);
+        advance();
+    }
+    if(current_char == '.' && isDigit(peek())){
+        number.push_back(current_char);
+        advance();
+        while(isDigit(current_char)){
+            number.push_back(current_char);
+            advance();
+        }
+    }
+
+    if(current_char == '%'){
+        advance();
+        return {StylePercentage, number + "%"};
+    }
+    if(isNameStart(current_char)){
+        std::string unit = consumeName();
+        auto itr = known_units.find(unit);
+        return {itr != known_units.end() ? itr->second : StyleDimension, number + unit};
+    }
+    return {StyleNumber, number};
+};
+
+StyleSheetToken StyleSheetLexer::consumeString(){
+    char quote = current_char;
+    std::string str(1, quote);
+    advance();
+    while(current_char != '\0' && current_char != quote && current_char != '\n'){
+        if(current_char == '\\'){
+            str.push_back(current_char);
+            advance();
+            if(current_char == '\0') break;
+        }
+        str.push_back(current_char);
+        advance();
+    }
+    str.push_back(quote);
+    if(current_char == quote)
+        advance();
+    return {StyleString, str};
+};
+
+void StyleSheetLexer::skipComment(){
+    advance();
+    advance();
+    while(current_char != '\0' && !(current_char == '*' && peek() == '/'))
+        advance();
+    advance();
+    advance();
+};
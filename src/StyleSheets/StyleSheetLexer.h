@@ -1,5 +1,7 @@
 #pragma once
+#include <cctype>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -9,6 +11,9 @@ using namespace std::literals::string_view_literals;
 enum StyleSheetTokenType {
     StyleClassSelector, StyleIdSelector, StyleIdentifier, StyleOpenBrace, StyleCloseBrace,
     StyleOpenParen, StyleCloseParen, StyleNumber, StylePx, StylePercentage, StyleEm,
+    StyleDimension, StyleString, StyleAtKeyword, StyleColon, StyleSemicolon, StyleComma,
+    StyleGreater, StylePlus, StyleTilde, StyleStar, StyleOpenBracket, StyleCloseBracket,
+    StyleBang, StyleWhitespace, StyleDelim,
     StyleEOF
 };
 
@@ -20,13 +25,18 @@ struct StyleSheetToken {
 class StyleSheetLexer {
 public:
     std::unordered_map<std::string_view, StyleSheetTokenType> known_style_tokens = {
-        {".", StyleClassSelector}, {"#", StyleIdSelector}, {"{", StyleOpenBrace},
+        {".", StyleClassSelector}, {"{", StyleOpenBrace},
         {"}", StyleCloseBrace}, {"(", StyleOpenParen}, {")", StyleCloseParen},
+        {":", StyleColon}, {";", StyleSemicolon}, {",", StyleComma}, {">", StyleGreater},
+        {"+", StylePlus}, {"~", StyleTilde}, {"*", StyleStar}, {"[", StyleOpenBracket},
+        {"]", StyleCloseBracket}, {"!", StyleBang}
+    };
+    std::unordered_map<std::string_view, StyleSheetTokenType> known_units = {
+        {"px", StylePx}, {"%", StylePercentage}, {"em", StyleEm}
     };
-    
 
     std::unordered_set<char> skip_chars = {
-        ' ', '\t', '\n', '\r'
+        ' ', '\t', '\n', '\r', '\f'
     };
     std::vector<StyleSheetToken> tokenize(std::string& code);
 
@@ -36,7 +46,27 @@ public:
 
     void advance(){
         if(current_char != '\0' && current_pos < actual_code->size()){
-            current_char = (*actual_code)[++current_pos];
+            current_pos++;
+            current_char = current_pos < actual_code->size() ? (*actual_code)[current_pos] : '\0';
         }
     }
-};
\ No newline at end of file
+    char peek(size_t offset = 1){
+        return current_pos + offset < actual_code->size() ? (*actual_code)[current_pos + offset] : '\0';
+    }
+
+    static bool isNameStart(char ch){
+        return std::isalpha(static_cast<unsigned char>(ch)) || ch == '_' || ch == '-' ||
+            static_cast<unsigned char>(ch) >= 0x80;
+    }
+    static bool isNameChar(char ch){
+        return isNameStart(ch) || std::isdigit(static_cast<unsigned char>(ch));
+    }
+    static bool isDigit(char ch){
+        return std::isdigit(static_cast<unsigned char>(ch));
+    }
+
+    std::string consumeName();
+    StyleSheetToken consumeNumber();
+    StyleSheetToken consumeString();
+    void skipComment();
+};
@@ -0,0 +1,286 @@
+#include "StyleSheetParser.h"
+#include <algorithm>
+
+StyleSheet StyleSheetParser::parseStyleSheet(std::string code) {
+    StyleSheetLexer lexer;
+    std::vector<StyleSheetToken> tokens = lexer.tokenize(code);
+    StyleSheetParser parser;
+    return parser.parse(tokens);
+};
+
+StyleSheet StyleSheetParser::parse(std::vector<StyleSheetToken>& target_tokens) {
+    tokens = &target_tokens;
+    current_pos = 0;
+
+    StyleSheet sheet;
+    while(at().type != StyleEOF){
+        skipWhitespace();
+        switch(at().type){
+            case StyleEOF: break;
+            case StyleAtKeyword: parseAtRule(sheet); break;
+            // stray terminators left over from a broken rule
+            case StyleSemicolon: case StyleCloseBrace: current_pos++; break;
+            default: parseQualifiedRule(sheet); break;
+        }
+    }
+
+    tokens = nullptr;
+    current_pos = 0;
+    return sheet;
+};
+
+void StyleSheetParser::skipWhitespace() {
+    while(at().type == StyleWhitespace)
+        current_pos++;
+};
+
+size_t StyleSheetParser::findBlockEnd(size_t open_pos) {
+    int depth = 0;
+    size_t pos = open_pos;
+    for(; (*tokens)[pos].type != StyleEOF; pos++){
+        if((*tokens)[pos].type == StyleOpenBrace)
+            depth++;
+        else if((*tokens)[pos].type == StyleCloseBrace && --depth == 0)
+            return pos + 1;
+    }
+    return pos;
+};
+
+void StyleSheetParser::parseAtRule(StyleSheet& sheet) {
+    size_t start = current_pos;
+    size_t end = current_pos;
+    for(; (*tokens)[end].type != StyleEOF; end++){
+        if((*tokens)[end].type == StyleSemicolon){
+            end++;
+            break;
+        }
+        if((*tokens)[end].type == StyleOpenBrace){
+            end = findBlockEnd(end);
+            break;
+        }
+    }
+
+    // @media, @keyframes, @import ... are gtk's business ( or nobody's )
+    sheet.residual_css += serialize(*tokens, start, end) + "\n";
+    current_pos = end;
+};
+
+void StyleSheetParser::parseQualifiedRule(StyleSheet& sheet) {
+    size_t start = current_pos;
+    size_t brace_pos = current_pos;
+    while((*tokens)[brace_pos].type != StyleOpenBrace && (*tokens)[brace_pos].type != StyleEOF)
+        brace_pos++;
+
+    if((*tokens)[brace_pos].type == StyleEOF){
+        current_pos = brace_pos;
+        return;
+    }
+
+    size_t end = findBlockEnd(brace_pos);
+    bool terminated = (*tokens)[end - 1].type == StyleCloseBrace && end - 1 > brace_pos;
+    size_t block_end = terminated ? end - 1 : end;
+
+    StyleRule rule;
+    if(parseSelectorList(*tokens, start, brace_pos, rule.selectors)){
+        rule.declarations = parseDeclarations(*tokens, brace_pos + 1, block_end);
+        if(!rule.declarations.empty())
+            sheet.rules.push_back(std::move(rule));
+    } else {
+        sheet.residual_css += serialize(*tokens, start, end) + (terminated ? "\n" : "}\n");
+    }
+
+    current_pos = end;
+};
+
+std::vector<StyleDeclaration> StyleSheetParser::parseDeclarations(const std::vector<StyleSheetToken>& tokens,
+    size_t begin, size_t end) {
+    std::vector<StyleDeclaration> declarations;
+    size_t pos = begin;
+
+    while(pos < end){
+        while(pos < end && (tokens[pos].type == StyleWhitespace || tokens[pos].type == StyleSemicolon))
+            pos++;
+        if(pos >= end)
+            break;
+
+        // value runs until the next ; that isn't nested inside a function like rgb( ; )
+        size_t value_end = pos;
+        int depth = 0;
+        for(; value_end < end; value_end++){
+            StyleSheetTokenType type = tokens[value_end].type;
+            if(type == StyleOpenParen || type == StyleOpenBrace || type == StyleOpenBracket) depth++;
+            else if(type == StyleCloseParen || type == StyleCloseBrace || type == StyleCloseBracket) depth--;
+            else if(type == StyleSemicolon && depth <= 0) break;
+        }
+
+        size_t name_pos = pos;
+        pos++;
+        while(pos < value_end && tokens[pos].type == StyleWhitespace)
+            pos++;
+
+        if(tokens[name_pos].type != StyleIdentifier || pos >= value_end || tokens[pos].type != StyleColon){
+            pos = value_end;
+            continue;
+        }
+
+        StyleDeclaration declaration;
+        declaration.property = tokens[name_pos].symbol;
+        std::transform(declaration.property.begin(), declaration.property.end(),
+            declaration.property.begin(), [](unsigned char ch){ return std::tolower(ch); });
+
+        size_t value_begin = pos + 1;
+        size_t value_last = value_end;
+        while(value_last > value_begin && tokens[value_last - 1].type == StyleWhitespace)
+            value_last--;
+
+        if(value_last > value_begin && tokens[value_last - 1].type == StyleIdentifier &&
+            tokens[value_last - 1].symbol == "important"){
+            size_t bang_pos = value_last - 1;
+            while(bang_pos > value_begin && tokens[bang_pos - 1].type == StyleWhitespace)
+                bang_pos--;
+            if(bang_pos > value_begin && tokens[bang_pos - 1].type == StyleBang){
+                declaration.important = true;
+                value_last = bang_pos - 1;
+            }
+        }
+
+        declaration.value = serialize(tokens, value_begin, value_last);
+        if(!declaration.value.empty())
+            declarations.push_back(std::move(declaration));
+
+        pos = value_end;
+    }
+
+    return declarations;
+};
+
+bool StyleSheetParser::parseSelectorList(const std::vector<StyleSheetToken>& tokens, size_t begin, size_t end,
+    std::vector<ComplexSelector>& out) {
+    size_t part_begin = begin;
+    for(size_t pos = begin; pos <= end; pos++){
+        if(pos == end || tokens[pos].type == StyleComma){
+            ComplexSelector selector;
+            if(!parseComplexSelector(tokens, part_begin, pos, selector))
+                return false;
+            out.push_back(std::move(selector));
+            part_begin = pos + 1;
+        }
+    }
+    return !out.empty();
+};
+
+bool StyleSheetParser::parseComplexSelector(const std::vector<StyleSheetToken>& tokens, size_t begin, size_t end,
+    ComplexSelector& out) {
+    CompoundSelector compound;
+    bool compound_open = false;
+    bool saw_whitespace = false;
+    bool saw_child = false;
+    uint32_t ids = 0, classes = 0, tag_names = 0;
+
+    for(size_t pos = begin; pos < end; pos++){
+        const StyleSheetToken& token = tokens[pos];
+        switch(token.type){
+            case StyleWhitespace:
+                if(compound_open) saw_whitespace = true;
+                continue;
+            case StyleGreater:
+                if(!compound_open || saw_child) return false;
+                saw_child = true;
+                continue;
+            case StyleIdentifier: case StyleStar: case StyleIdSelector: case StyleClassSelector:
+                break;
+            // pseudo classes, attribute selectors, sibling combinators, ...
+            default:
+                return false;
+        }
+
+        if(compound_open && (saw_whitespace || saw_child)){
+            out.compounds.push_back(std::move(compound));
+            out.combinators.push_back(saw_child ? ChildCombinator : DescendantCombinator);
+            compound = CompoundSelector();
+            saw_whitespace = saw_child = false;
+        }
+
+        if(token.type == StyleIdentifier || token.type == StyleStar){
+            // a type selector can only lead a compound
+            if(compound_open) return false;
+            if(token.type == StyleIdentifier){
+                compound.tag_name = token.symbol;
+                std::transform(compound.tag_name.begin(), compound.tag_name.end(),
+                    compound.tag_name.begin(), [](unsigned char ch){ return std::tolower(ch); });
+                tag_names++;
+            }
+        } else if(token.type == StyleIdSelector){
+            compound.id = token.symbol.substr(1);
+            ids++;
+        } else {
+            if(pos + 1 >= end || tokens[pos + 1].type != StyleIdentifier) return false;
+            compound.classes.push_back(tokens[++pos].symbol);
+            classes++;
+        }
+        compound_open = true;
+    }
+
+    if(!compound_open || saw_child)
+        return false;
+
+    out.compounds.push_back(std::move(compound));
+    out.specificity = (std::min(ids, 255u) << 16) | (std::min(classes, 255u) << 8) | std::min(tag_names, 255u);
+    return true;
+};
+
+std::string StyleSheetParser::serialize(const std::vector<StyleSheetToken>& tokens, size_t begin, size_t end) {
+    std::string result;
+    for(size_t pos = begin; pos < end && tokens[pos].type != StyleEOF; pos++){
+        if(tokens[pos].type == StyleWhitespace){
+            if(!result.empty() && result.back() != ' ')
+                result.push_back(' ');
+            continue;
+        }
+        result += tokens[pos].symbol;
+    }
+    if(!result.empty() && result.back() == ' ')
+        result.pop_back();
+    return result;
+};
+
+std::string StyleSheetParser::sanitizeDeclarations(std::string code) {
+    StyleSheetLexer lexer;
+    std::vector<StyleSheetToken> tokens = lexer.tokenize(code);
+
+    std::string result;
+    for(auto& declaration : parseDeclarations(tokens, 0, tokens.size() - 1)){
+        if(!isSafeInsideRule(declaration.property) || !isSafeInsideRule(declaration.value))
+            continue;
+        // gtk has no !important, the inline layer already sits above the sheets
+        result += declaration.property + ": " + declaration.value + "; ";
+    }
+    if(!result.empty())
+        result.pop_back();
+    return result;
+};
+
+bool StyleSheetParser::isSafeInsideRule(const std::string& text) {
+    // escapes are refused outright, the lexer resolves them inside names so "\}" comes back as a bare }
+    std::string open_brackets;
+    char quote = '\0';
+    for(size_t pos = 0; pos < text.size(); pos++){
+        char ch = text[pos];
+        if(ch == '{' || ch == '}' || ch == ';' || ch == '\\' || ch == '\n' ||
+            (ch == '/' && pos + 1 < text.size() && text[pos + 1] == '*'))
+            return false;
+
+        if(quote != '\0'){
+            if(ch == quote) quote = '\0';
+        } else if(ch == '"' || ch == '\''){
+            quote = ch;
+        } else if(ch == '(' || ch == '['){
+            open_brackets.push_back(ch == '(' ? ')' : ']');
+        } else if(ch == ')' || ch == ']'){
+            if(open_brackets.empty() || open_brackets.back() != ch)
+                return false;
+            open_brackets.pop_back();
+        }
+    }
+    return quote == '\0' && open_brackets.empty();
+};
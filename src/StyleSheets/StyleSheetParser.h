@@ -0,0 +1,75 @@
+#pragma once
+#include "StyleSheetLexer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+//  Turns StyleSheetLexer Tokens Into Rules With Selectors The Matcher Understands,
+//  Anything It Can't Match Itself ( Pseudo Classes, Attributes, Siblings, At Rules )
+//  Is Serialized Back Into residual_css And Handed To Gtk Untouched
+//
+
+struct StyleDeclaration {
+    std::string property;
+    std::string value;
+    bool important = false;
+};
+
+enum SelectorCombinator {
+    DescendantCombinator, ChildCombinator
+};
+
+struct CompoundSelector {
+    std::string tag_name; // empty for * or when only classes / id were given
+    std::string id;
+    std::vector<std::string> classes;
+};
+
+struct ComplexSelector {
+    // left to right, combinators[i] sits between compounds[i] and compounds[i + 1]
+    std::vector<CompoundSelector> compounds;
+    std::vector<SelectorCombinator> combinators;
+    uint32_t specificity = 0;
+};
+
+struct StyleRule {
+    std::vector<ComplexSelector> selectors;
+    std::vector<StyleDeclaration> declarations;
+};
+
+struct StyleSheet {
+    std::vector<StyleRule> rules;
+    std::string residual_css;
+};
+
+class StyleSheetParser {
+public:
+    StyleSheet parse(std::vector<StyleSheetToken>& tokens);
+    static StyleSheet parseStyleSheet(std::string code);
+
+    static std::vector<StyleDeclaration> parseDeclarations(const std::vector<StyleSheetToken>& tokens,
+        size_t begin, size_t end);
+    static bool parseSelectorList(const std::vector<StyleSheetToken>& tokens, size_t begin, size_t end,
+        std::vector<ComplexSelector>& out);
+    static std::string serialize(const std::vector<StyleSheetToken>& tokens, size_t begin, size_t end);
+    // a style="" attribute as "property: value; ..." that is safe to put inside a generated rule,
+    // declarations that could close the rule, open a comment or leave a bracket open are dropped
+    static std::string sanitizeDeclarations(std::string code);
+
+private:
+    std::vector<StyleSheetToken>* tokens = nullptr;
+    size_t current_pos = 0;
+
+    StyleSheetToken& at(){ return (*tokens)[current_pos]; };
+    void skipWhitespace();
+    // returns the index just past the token that closes the block opened at current_pos
+    size_t findBlockEnd(size_t open_pos);
+
+    void parseAtRule(StyleSheet& sheet);
+    void parseQualifiedRule(StyleSheet& sheet);
+
+    static bool isSafeInsideRule(const std::string& text);
+    static bool parseComplexSelector(const std::vector<StyleSheetToken>& tokens, size_t begin, size_t end,
+        ComplexSelector& out);
+};
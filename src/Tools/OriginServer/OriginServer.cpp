@@ -0,0 +1,485 @@
+#include "../../HttpManager/HttpTransport.h"
+#include <boost/beast.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <nghttp2/nghttp2.h>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//
+//  A Small Origin Server For Testing And Benchmarking The Network Stack Offline. It Serves The
+//  Files Under A Fixture Directory Over Plain Http ( Or Https With --tls ), And Can Add Latency
+//  Before Every Response And Cap The Bandwidth Each Body Is Sent With. With --http2 It Offers h2
+//  Through Alpn Next To http/1.1, So Both Of HttpManager's Async Paths Can Be Run Against It
+//
+//  usage: OriginServer [--port 8080] [--root fixtures] [--latency-ms 0] [--bandwidth-kbps 0]
+//                      [--max-age -1] [--tls cert.pem key.pem [--http2]]
+//
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace fs = std::filesystem;
+
+struct OriginConfig {
+    unsigned short port = 8080;
+    fs::path root = "fixtures";
+    std::chrono::milliseconds latency{0};
+    // 0 for as fast as the socket goes
+    size_t bandwidth_bytes_per_second = 0;
+    // Cache-Control max-age on every 200, left out when negative
+    int max_age = -1;
+    std::string cert_file;
+    std::string key_file;
+    bool http2 = false;
+};
+
+static const std::unordered_map<std::string, std::string> content_types = {
+    {".html", "text/html"}, {".htm", "text/html"}, {".css", "text/css"}, {".sig", "text/plain"},
+    {".txt", "text/plain"}, {".json", "application/json"}, {".png", "image/png"},
+    {".jpg", "image/jpeg"}, {".jpeg", "image/jpeg"}, {".webp", "image/webp"}, {".gif", "image/gif"},
+    {".mp4", "video/mp4"}, {".webm", "video/webm"}
+};
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream strea(path, std::ios::binary);
+    std::stringstream contents;
+    contents << strea.rdbuf();
+    return contents.str();
+};
+
+// the body goes out in slices with a pause after each, so it takes as long as the cap says
+static void writeThrottled(HttpTransport& transport, std::string_view body, size_t bytes_per_second) {
+    if(bytes_per_second == 0){
+        net::write(transport, net::buffer(body.data(), body.size()));
+        return;
+    }
+
+    // ten slices a second keeps the rate smooth without a syscall per byte
+    size_t slice = std::max<size_t>(bytes_per_second / 10, 1);
+    for(size_t offset = 0; offset < body.size(); offset += slice){
+        size_t length = std::min(slice, body.size() - offset);
+        net::write(transport, net::buffer(body.data() + offset, length));
+        // by what was written, h2 frames are mostly shorter than a slice
+        std::this_thread::sleep_for(std::chrono::microseconds(1000000 * length / bytes_per_second));
+    }
+};
+
+// the answer to a request whichever protocol it came over. the body is filled in for HEAD too,
+// its length goes in Content-Length, it's up to the caller not to send it
+static http::response<http::string_body> makeResponse(http::verb method, std::string target,
+    beast::string_view if_none_match, const OriginConfig& config) {
+    http::response<http::string_body> res;
+    res.set(http::field::server, "OriginServer");
+
+    target = target.substr(0, target.find('?'));
+    if(target.ends_with('/'))
+        target += "index.html";
+    fs::path file_path = (config.root / fs::path(target).relative_path()).lexically_normal();
+    // compared a component at a time, a string prefix would let root2/ through for root/
+    fs::path root = config.root.lexically_normal();
+    if(!root.has_filename())
+        root = root.parent_path();
+    bool inside_root = std::mismatch(root.begin(), root.end(), file_path.begin(), file_path.end()).first == root.end();
+
+    if((method != http::verb::get && method != http::verb::head) || !inside_root ||
+        !fs::is_regular_file(file_path)){
+        res.result(http::status::not_found);
+        res.set(http::field::content_type, "text/plain");
+        res.body() = "not found";
+        res.content_length(res.body().size());
+        return res;
+    }
+
+    // size and mtime, enough to tell two versions of a fixture apart
+    std::string etag = "\"" + std::to_string(fs::file_size(file_path)) + "-" +
+        std::to_string(fs::last_write_time(file_path).time_since_epoch().count()) + "\"";
+    res.set(http::field::etag, etag);
+    if(config.max_age >= 0)
+        res.set(http::field::cache_control, "max-age=" + std::to_string(config.max_age));
+
+    if(if_none_match == etag){
+        res.result(http::status::not_modified);
+        return res;
+    }
+
+    auto type_itr = content_types.find(file_path.extension().string());
+    res.result(http::status::ok);
+    res.set(http::field::content_type, type_itr != content_types.end() ? type_itr->second : "application/octet-stream");
+    res.body() = readFile(file_path);
+    res.content_length(res.body().size());
+    return res;
+};
+
+static bool handleRequest(HttpTransport& transport, const http::request<http::string_body>& req,
+    const OriginConfig& config) {
+    std::this_thread::sleep_for(config.latency);
+
+    http::response<http::string_body> res = makeResponse(req.method(), std::string(req.target()),
+        req[http::field::if_none_match], config);
+    res.version(req.version());
+    res.keep_alive(req.keep_alive());
+
+    http::response_serializer<http::string_body> serializer(res);
+    http::write_header(transport, serializer);
+    if(req.method() != http::verb::head && res.result() != http::status::not_modified)
+        writeThrottled(transport, res.body(), config.bandwidth_bytes_per_second);
+    return res.keep_alive();
+};
+
+static void serveConnection(HttpTransport transport, const OriginConfig& config) {
+    beast::flat_buffer buffer;
+    try {
+        for(;;){
+            http::request<http::string_body> req;
+            http::read(transport, buffer, req);
+            if(!handleRequest(transport, req, config))
+                break;
+        }
+    } catch(const boost::system::system_error& error) {
+        if(error.code() != http::error::end_of_stream && error.code() != net::error::eof &&
+            error.code() != net::ssl::error::stream_truncated)
+            std::cout << "connection error: " << error.what() << std::endl;
+    }
+    boost::system::error_code ec;
+    transport.getSocket().shutdown(tcp::socket::shutdown_both, ec);
+};
+
+//
+//  One h2 Connection, Served On Its Own Thread Like An http/1.1 One. Every Request Waits Out The
+//  Latency From When It Arrived, So Streams Sent Together Are Answered Together Instead Of One
+//  After Another. The Bandwidth Cap Applies To The Connection As A Whole, Which Is What All Its
+//  Streams Share Anyway. Reads And The Latency Timer Are Async On The Connection's Own Io Context,
+//  Polling The Socket Would Miss Tls Records The Ssl Stream Has Already Read Ahead
+//
+
+class Http2Connection {
+public:
+    Http2Connection(HttpTransport& tls_transport, const OriginConfig& origin_config);
+    ~Http2Connection();
+    Http2Connection(const Http2Connection&) = delete;
+    Http2Connection& operator=(const Http2Connection&) = delete;
+
+    // runs the transport's io context, returns when the client goes away or sends GOAWAY
+    void serve(net::io_context& connection_ctx);
+
+private:
+    struct Stream {
+        http::verb method = http::verb::unknown;
+        std::string target;
+        std::string if_none_match;
+        // set once the request is complete
+        std::optional<std::chrono::steady_clock::time_point> ready_at;
+        http::response<http::string_body> res;
+        size_t sent = 0;
+    };
+
+    HttpTransport& transport;
+    const OriginConfig& config;
+    nghttp2_session* session = nullptr;
+    net::steady_timer latency_timer;
+    std::vector<uint8_t> read_buffer = std::vector<uint8_t>(16 * 1024);
+    bool done = false;
+    // a map so the data source pointers handed to nghttp2 stay put
+    std::map<int32_t, Stream> streams;
+
+    void readMore();
+    // answers what's ready, sends what nghttp2 has and sets the timer for the next response
+    void flush();
+    void finish();
+    void respondReady();
+    // -1 when nothing is waiting on its latency
+    int getMsUntilNextReady();
+
+    static ssize_t onSend(nghttp2_session* session, const uint8_t* data, size_t length, int flags, void* user_data);
+    static int onBeginHeaders(nghttp2_session* session, const nghttp2_frame* frame, void* user_data);
+    static int onHeader(nghttp2_session* session, const nghttp2_frame* frame, const uint8_t* name, size_t name_length,
+        const uint8_t* value, size_t value_length, uint8_t flags, void* user_data);
+    static int onFrameRecv(nghttp2_session* session, const nghttp2_frame* frame, void* user_data);
+    static int onStreamClose(nghttp2_session* session, int32_t stream_id, uint32_t error_code, void* user_data);
+    static ssize_t readBody(nghttp2_session* session, int32_t stream_id, uint8_t* buf, size_t length,
+        uint32_t* data_flags, nghttp2_data_source* source, void* user_data);
+};
+
+Http2Connection::Http2Connection(HttpTransport& tls_transport, const OriginConfig& origin_config):
+    transport(tls_transport), config(origin_config), latency_timer(tls_transport.get_executor()) {
+    nghttp2_session_callbacks* callbacks;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_send_callback(callbacks, onSend);
+    nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, onBeginHeaders);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, onHeader);
+    nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, onFrameRecv);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, onStreamClose);
+    nghttp2_session_server_new(&session, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+
+    nghttp2_settings_entry settings[] = {{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 100}};
+    nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, settings, std::size(settings));
+};
+
+Http2Connection::~Http2Connection() {
+    nghttp2_session_del(session);
+};
+
+void Http2Connection::serve(net::io_context& connection_ctx) {
+    flush();
+    readMore();
+    connection_ctx.run();
+};
+
+void Http2Connection::readMore() {
+    transport.async_read_some(net::buffer(read_buffer), [this](boost::system::error_code ec, size_t length){
+        if(done)
+            return;
+        if(ec){
+            if(ec != net::error::eof && ec != net::ssl::error::stream_truncated)
+                std::cout << "connection error: " << ec.message() << std::endl;
+            finish();
+            return;
+        }
+        if(nghttp2_session_mem_recv(session, read_buffer.data(), length) < 0){
+            finish();
+            return;
+        }
+        flush();
+        if(!done)
+            readMore();
+    });
+};
+
+void Http2Connection::flush() {
+    respondReady();
+    if(nghttp2_session_send(session) != 0 ||
+        (!nghttp2_session_want_read(session) && !nghttp2_session_want_write(session))){
+        finish();
+        return;
+    }
+
+    int wait_ms = getMsUntilNextReady();
+    if(wait_ms < 0)
+        return;
+    latency_timer.expires_after(std::chrono::milliseconds(wait_ms));
+    latency_timer.async_wait([this](boost::system::error_code ec){
+        if(!ec && !done)
+            flush();
+    });
+};
+
+void Http2Connection::finish() {
+    done = true;
+    latency_timer.cancel();
+    boost::system::error_code ec;
+    transport.getSocket().cancel(ec);
+};
+
+void Http2Connection::respondReady() {
+    auto now = std::chrono::steady_clock::now();
+    for(auto& [stream_id, stream] : streams){
+        if(!stream.ready_at || *stream.ready_at > now)
+            continue;
+        stream.ready_at.reset();
+
+        stream.res = makeResponse(stream.method, stream.target, stream.if_none_match, config);
+        // h2 wants lowercase field names, beast keeps them the way they're usually written
+        std::vector<std::pair<std::string, std::string>> fields;
+        fields.emplace_back(":status", std::to_string(stream.res.result_int()));
+        for(auto& field : stream.res){
+            std::string name(field.name_string());
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c){ return std::tolower(c); });
+            fields.emplace_back(std::move(name), std::string(field.value()));
+        }
+
+        std::vector<nghttp2_nv> headers;
+        for(auto& [name, value] : fields)
+            headers.push_back({(uint8_t*)name.data(), (uint8_t*)value.data(), name.size(), value.size(),
+                NGHTTP2_NV_FLAG_NONE});
+
+        bool has_body = stream.method != http::verb::head && stream.res.result() != http::status::not_modified;
+        nghttp2_data_provider body_provider;
+        body_provider.source.ptr = &stream;
+        body_provider.read_callback = readBody;
+        // nghttp2 copies the headers, fields can go once it returns
+        nghttp2_submit_response(session, stream_id, headers.data(), headers.size(), has_body ? &body_provider : nullptr);
+    }
+};
+
+int Http2Connection::getMsUntilNextReady() {
+    std::optional<std::chrono::steady_clock::time_point> next;
+    for(auto& [stream_id, stream] : streams)
+        if(stream.ready_at && (!next || *stream.ready_at < *next))
+            next = stream.ready_at;
+    if(!next)
+        return -1;
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(*next - std::chrono::steady_clock::now());
+    return std::max<int>(wait.count(), 0);
+};
+
+ssize_t Http2Connection::onSend(nghttp2_session* session, const uint8_t* data, size_t length,
+    int flags, void* user_data) {
+    Http2Connection* self = static_cast<Http2Connection*>(user_data);
+    try {
+        writeThrottled(self->transport, std::string_view((const char*)data, length),
+            self->config.bandwidth_bytes_per_second);
+    } catch(const boost::system::system_error&) {
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    }
+    return length;
+};
+
+int Http2Connection::onBeginHeaders(nghttp2_session* session, const nghttp2_frame* frame, void* user_data) {
+    Http2Connection* self = static_cast<Http2Connection*>(user_data);
+    if(frame->hd.type == NGHTTP2_HEADERS && frame->headers.cat == NGHTTP2_HCAT_REQUEST)
+        self->streams.try_emplace(frame->hd.stream_id);
+    return 0;
+};
+
+int Http2Connection::onHeader(nghttp2_session* session, const nghttp2_frame* frame, const uint8_t* name,
+    size_t name_length, const uint8_t* value, size_t value_length, uint8_t flags, void* user_data) {
+    Http2Connection* self = static_cast<Http2Connection*>(user_data);
+    auto stream_itr = self->streams.find(frame->hd.stream_id);
+    if(stream_itr == self->streams.end())
+        return 0;
+
+    beast::string_view header_name((const char*)name, name_length);
+    beast::string_view header_value((const char*)value, value_length);
+    if(header_name == ":method")
+        stream_itr->second.method = http::string_to_verb(header_value);
+    else if(header_name == ":path")
+        stream_itr->second.target = std::string(header_value);
+    else if(header_name == "if-none-match")
+        stream_itr->second.if_none_match = std::string(header_value);
+    return 0;
+};
+
+int Http2Connection::onFrameRecv(nghttp2_session* session, const nghttp2_frame* frame, void* user_data) {
+    Http2Connection* self = static_cast<Http2Connection*>(user_data);
+    if((frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA) ||
+        !(frame->hd.flags & NGHTTP2_FLAG_END_STREAM))
+        return 0;
+
+    auto stream_itr = self->streams.find(frame->hd.stream_id);
+    if(stream_itr != self->streams.end())
+        stream_itr->second.ready_at = std::chrono::steady_clock::now() + self->config.latency;
+    return 0;
+};
+
+int Http2Connection::onStreamClose(nghttp2_session* session, int32_t stream_id, uint32_t error_code,
+    void* user_data) {
+    static_cast<Http2Connection*>(user_data)->streams.erase(stream_id);
+    return 0;
+};
+
+ssize_t Http2Connection::readBody(nghttp2_session* session, int32_t stream_id, uint8_t* buf, size_t length,
+    uint32_t* data_flags, nghttp2_data_source* source, void* user_data) {
+    Stream* stream = static_cast<Stream*>(source->ptr);
+    const std::string& body = stream->res.body();
+    size_t copied = std::min(length, body.size() - stream->sent);
+    std::copy_n(body.data() + stream->sent, copied, buf);
+    stream->sent += copied;
+    if(stream->sent == body.size())
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    return copied;
+};
+
+// offers h2 first, a client that doesn't know it gets http/1.1
+static int selectAlpn(SSL* ssl, const unsigned char** out, unsigned char* out_length,
+    const unsigned char* in, unsigned int in_length, void* arg) {
+    static const unsigned char protocols[] = "\x02h2\x08http/1.1";
+    if(SSL_select_next_proto((unsigned char**)out, out_length, protocols, sizeof(protocols) - 1, in, in_length)
+        != OPENSSL_NPN_NEGOTIATED)
+        return SSL_TLSEXT_ERR_NOACK;
+    return SSL_TLSEXT_ERR_OK;
+};
+
+static bool isHttp2(HttpTransport& transport) {
+    const unsigned char* protocol = nullptr;
+    unsigned int protocol_length = 0;
+    SSL_get0_alpn_selected(transport.getSsl(), &protocol, &protocol_length);
+    return protocol_length == 2 && std::memcmp(protocol, "h2", 2) == 0;
+};
+
+static OriginConfig parseArgs(int argc, char** argv) {
+    OriginConfig config;
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if(i + 1 >= argc)
+                throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+
+        if(arg == "--port") config.port = std::stoi(next());
+        else if(arg == "--root") config.root = next();
+        else if(arg == "--latency-ms") config.latency = std::chrono::milliseconds(std::stoi(next()));
+        else if(arg == "--bandwidth-kbps") config.bandwidth_bytes_per_second = std::stoull(next()) * 1024 / 8;
+        else if(arg == "--max-age") config.max_age = std::stoi(next());
+        else if(arg == "--tls"){
+            config.cert_file = next();
+            config.key_file = next();
+        }
+        else if(arg == "--http2") config.http2 = true;
+        else throw std::runtime_error("unknown argument " + arg);
+    }
+    if(config.http2 && config.cert_file.empty())
+        throw std::runtime_error("--http2 needs --tls, h2 is only offered through alpn");
+    return config;
+};
+
+int main(int argc, char** argv) {
+    try {
+        OriginConfig config = parseArgs(argc, argv);
+        net::io_context io_ctx;
+        ssl::context ssl_ctx(ssl::context::tls_server);
+        bool use_tls = !config.cert_file.empty();
+        if(use_tls){
+            ssl_ctx.use_certificate_chain_file(config.cert_file);
+            ssl_ctx.use_private_key_file(config.key_file, ssl::context::pem);
+            if(config.http2)
+                SSL_CTX_set_alpn_select_cb(ssl_ctx.native_handle(), selectAlpn, nullptr);
+        }
+
+        tcp::acceptor acceptor(io_ctx, {tcp::v4(), config.port});
+        std::cout << "serving " << fs::absolute(config.root) << " on " << (use_tls ? "https" : "http")
+            << "://127.0.0.1:" << config.port << std::endl;
+
+        // a thread per connection, plenty for a test server and every connection is independent.
+        // each gets its own io context too, an h2 one runs it
+        for(;;){
+            auto connection_ctx = std::make_unique<net::io_context>();
+            tcp::socket socket = acceptor.accept(*connection_ctx);
+            std::thread([connection_ctx = std::move(connection_ctx), socket = std::move(socket), &ssl_ctx,
+                &config, use_tls]() mutable {
+                try {
+                    if(!use_tls){
+                        serveConnection(HttpTransport(std::move(socket)), config);
+                        return;
+                    }
+                    SslStream stream(std::move(socket), ssl_ctx);
+                    stream.handshake(SslStream::server);
+                    HttpTransport transport(std::move(stream));
+                    if(!isHttp2(transport)){
+                        serveConnection(std::move(transport), config);
+                        return;
+                    }
+                    Http2Connection(transport, config).serve(*connection_ctx);
+                    boost::system::error_code ec;
+                    transport.getSocket().shutdown(tcp::socket::shutdown_both, ec);
+                } catch(const std::exception& error) {
+                    std::cout << "handshake failed: " << error.what() << std::endl;
+                }
+            }).detach();
+        }
+    } catch(const std::exception& error) {
+        std::cout << error.what() << std::endl;
+        return 1;
+    }
+};